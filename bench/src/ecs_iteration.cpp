@@ -0,0 +1,106 @@
+#include "ecs_iteration.h"
+
+#include <knoting/components.h>
+#include <knoting/log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace knot {
+namespace bench {
+
+using namespace components;
+
+namespace {
+
+struct Timing {
+    double minMs = 0.0;
+    double averageMs = 0.0;
+    float checksum = 0.0f;
+};
+
+// Renderables and plain transforms interleaved, a few renderables pooled as Inactive, with every storage filled in its
+// own shuffled order like a scene built up over time, so a view has to probe sparse sets that do not line up.
+void fill(entt::registry& registry, size_t entityCount) {
+    std::vector<entt::entity> entities(entityCount * 2);
+    for (size_t i = 0; i < entities.size(); ++i) {
+        entities[i] = registry.create();
+        registry.emplace<Transform>(entities[i], vec3(static_cast<float>(i), 0.0f, 0.0f));
+    }
+
+    std::mt19937 random(29);
+    std::shuffle(entities.begin(), entities.end(), random);
+    std::vector<entt::entity> renderables(entities.begin(), entities.begin() + entityCount);
+
+    for (entt::entity e : renderables) {
+        registry.emplace<InstanceMesh>(e);
+    }
+    std::shuffle(renderables.begin(), renderables.end(), random);
+    for (entt::entity e : renderables) {
+        registry.emplace<Material>(e);
+    }
+    // every 16th renderable sits in a pool
+    for (size_t i = 0; i < renderables.size(); i += 16) {
+        registry.emplace<Inactive>(renderables[i]);
+    }
+}
+
+template <typename Pass>
+Timing time_passes(size_t passes, Pass pass) {
+    Timing timing;
+    timing.minMs = std::numeric_limits<double>::max();
+    double totalMs = 0.0;
+    for (size_t i = 0; i < passes; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        timing.checksum += pass();
+        auto stop = std::chrono::high_resolution_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        timing.minMs = std::min(timing.minMs, ms);
+        totalMs += ms;
+    }
+    timing.averageMs = totalMs / static_cast<double>(std::max<size_t>(passes, 1));
+    return timing;
+}
+
+void report(const char* name, const Timing& view, const Timing& group) {
+    log::info("{}: view {:.3f} ms (min {:.3f}), group {:.3f} ms (min {:.3f}), {:.2f}x", name, view.averageMs,
+              view.minMs, group.averageMs, group.minMs, view.minMs / std::max(group.minMs, 1e-6));
+    // keeps the passes from being optimized away
+    log::debug("{} checksums {} {}", name, view.checksum, group.checksum);
+}
+
+}  // namespace
+
+void run_ecs_iteration(size_t entityCount, size_t passes) {
+    // separate registries, an owning group reorders its storages for every other view of the same registry
+    entt::registry viewRegistry;
+    entt::registry groupRegistry;
+    fill(viewRegistry, entityCount);
+    fill(groupRegistry, entityCount);
+
+    // the sets forward_renderer.cpp iterated before and iterates now
+    auto renderView = viewRegistry.view<Transform, InstanceMesh, Material>(entt::exclude<Inactive>);
+    auto renderGroup = groupRegistry.group<InstanceMesh, Material>(entt::get<Transform>, entt::exclude<Inactive>);
+    // both loops read what the pbr pass reads per entity, minus the draw calls
+    Timing renderViewTiming = time_passes(passes, [&]() {
+        float sum = 0.0f;
+        for (auto [e, transform, mesh, material] : renderView.each()) {
+            sum += transform.get_model_matrix()[3].x + static_cast<float>(material.get_program().idx & 1);
+        }
+        return sum;
+    });
+    Timing renderGroupTiming = time_passes(passes, [&]() {
+        float sum = 0.0f;
+        for (auto [e, mesh, material, transform] : renderGroup.each()) {
+            sum += transform.get_model_matrix()[3].x + static_cast<float>(material.get_program().idx & 1);
+        }
+        return sum;
+    });
+    report("render set", renderViewTiming, renderGroupTiming);
+}
+
+}  // namespace bench
+}  // namespace knot
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+namespace knot {
+namespace bench {
+
+// Times view<Transform, InstanceMesh, Material> against group<InstanceMesh, Material>(get<Transform>), both excluding
+// Inactive like the pbr pass, over entityCount renderables.
+void run_ecs_iteration(size_t entityCount, size_t passes);
+
+}  // namespace bench
+}  // namespace knot
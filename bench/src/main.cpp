@@ -0,0 +1,12 @@
+#include "ecs_iteration.h"
+
+#include <knoting/log.h>
+
+using namespace knot;
+
+int main() {
+    log::Logger::setup();
+    bench::run_ecs_iteration(100000, 50);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <knoting/collision_layer.h>
+#include <knoting/components.h>
+#include <knoting/px_variables_wrapper.h>
+#include <characterkinematic/PxControllerManager.h>
+
+namespace knot {
+namespace components {
+
+enum class CharacterShape : uint8_t { Capsule, Box, LAST };
+
+// Kinematic character moved by the PxControllerManager of the Physics module. The velocity is applied once per fixed
+// step in a single pass over every controller right before simulate, so the character slides, steps and rests on the
+// world instead of fighting the solver. The Transform follows the foot position.
+class CharacterController : public OwnedComponent {
+   public:
+    CharacterController();
+    // capsule: radius and the height between the two sphere centers, box: half width and full height
+    CharacterController(CharacterShape shape,
+                        float radius = 0.5f,
+                        float height = 1.0f,
+                        float stepOffset = 0.3f,
+                        float slopeLimitDegrees = 45.0f);
+    CharacterController(const CharacterController& other) = delete;
+    CharacterController& operator=(const CharacterController& other) = delete;
+    CharacterController(CharacterController&& other) noexcept;
+    CharacterController& operator=(CharacterController&& other) noexcept;
+
+    // creates the controller at the foot position of the Transform
+    void on_awake();
+    void on_load();
+    void on_destroy();
+
+    // walking velocity, gravity is added while airborne
+    void set_move_velocity(const vec3& velocity) { m_moveVelocity = velocity; }
+    vec3 get_move_velocity() const { return m_moveVelocity; }
+    // ignored unless grounded
+    void jump(float speed);
+    void teleport(const vec3& footPosition);
+    void set_layer(CollisionLayer layer);
+    CollisionLayer get_layer() const { return m_layer; }
+
+    // results of the latest fixed step
+    bool is_grounded() const { return m_collisionFlags.isSet(PxControllerCollisionFlag::eCOLLISION_DOWN); }
+    bool hit_ceiling() const { return m_collisionFlags.isSet(PxControllerCollisionFlag::eCOLLISION_UP); }
+    bool hit_sides() const { return m_collisionFlags.isSet(PxControllerCollisionFlag::eCOLLISION_SIDES); }
+    // what the step actually moved, shorter than requested when blocked and raised when it climbed a step
+    vec3 get_last_displacement() const { return m_lastDisplacement; }
+    vec3 get_foot_position() const;
+    // blend between the foot positions of the last two fixed steps, what the Transform shows between steps
+    vec3 get_interpolated_foot_position(float alpha) const;
+    float get_vertical_speed() const { return m_verticalSpeed; }
+    // puts the controller back to a captured step, used by physics snapshots
+    void restore_state(const vec3& footPosition, float verticalSpeed);
+
+    PxController* get_controller() const { return m_controller; }
+
+    // one fixed step, called by Physics for every controller in turn, the CCT is not safe to move concurrently
+    void move(float dt,
+              const PxVec3& gravity,
+              const CollisionMatrix& matrix,
+              PxQueryFilterCallback* filterCallback,
+              PxControllerFilterCallback* controllerFilterCallback,
+              const PxObstacleContext* obstacles);
+
+    // parks the capsule of a pooled character, it stays in the scene but neither simulates nor shows up in queries
+    void set_simulation_enabled(bool enabled);
+
+    template <class Archive>
+    void save(Archive& archive) const {
+        archive(CEREAL_NVP(m_shape), CEREAL_NVP(m_radius), CEREAL_NVP(m_height), CEREAL_NVP(m_stepOffset),
+                CEREAL_NVP(m_slopeLimitDegrees), CEREAL_NVP(m_layer));
+    }
+
+    template <class Archive>
+    void load(Archive& archive) {
+        archive(CEREAL_NVP(m_shape), CEREAL_NVP(m_radius), CEREAL_NVP(m_height), CEREAL_NVP(m_stepOffset),
+                CEREAL_NVP(m_slopeLimitDegrees), CEREAL_NVP(m_layer));
+    }
+
+   protected:
+    void create_controller(const vec3& footPosition);
+    void release_controller();
+    void apply_layer();
+    void reset_foot_history();
+
+    PxController* m_controller = nullptr;
+    std::shared_ptr<PxMaterial_ptr_wrapper> m_material;
+
+    CharacterShape m_shape = CharacterShape::Capsule;
+    float m_radius = 0.5f;
+    float m_height = 1.0f;
+    float m_stepOffset = 0.3f;
+    float m_slopeLimitDegrees = 45.0f;
+    CollisionLayer m_layer = 0;
+
+    vec3 m_moveVelocity = vec3(0.0f);
+    float m_verticalSpeed = 0.0f;
+    vec3 m_lastDisplacement = vec3(0.0f);
+    vec3 m_previousFoot = vec3(0.0f);
+    vec3 m_currentFoot = vec3(0.0f);
+    PxControllerCollisionFlags m_collisionFlags;
+};
+
+}  // namespace components
+}  // namespace knot
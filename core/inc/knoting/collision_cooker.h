@@ -0,0 +1,57 @@
+#pragma once
+
+#include <knoting/px_variables_wrapper.h>
+#include <knoting/types.h>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace knot {
+
+enum class CollisionMeshType { Convex, Triangle, LAST };
+
+// Cooks convex hulls and triangle meshes from Mesh assets. Cooked data is written to res/cooked/ keyed by a hash of
+// the source vertices, later runs (and later requests for the same mesh) only deserialize it.
+class CollisionCooker {
+   public:
+    CollisionCooker(PxFoundation& foundation, PxPhysics& physics);
+    ~CollisionCooker();
+
+    CollisionCooker(const CollisionCooker& other) = delete;
+    CollisionCooker& operator=(const CollisionCooker& other) = delete;
+
+    // the returned meshes are owned by the cooker and stay alive until it is destroyed
+    PxConvexMesh* acquire_convex_mesh(const std::string& meshPath);
+    PxTriangleMesh* acquire_triangle_mesh(const std::string& meshPath);
+
+    // not cached, the caller owns the returned height field. Safe to call from job workers.
+    PxHeightField* create_height_field(const PxHeightFieldDesc& desc);
+
+    static std::filesystem::path get_cooked_path();
+
+   private:
+    struct SourceData {
+        std::vector<PxVec3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    bool load_source(const std::string& meshPath, SourceData& source);
+    bool cook(CollisionMeshType type, const SourceData& source, PxDefaultMemoryOutputStream& output);
+    bool read_cooked(const std::filesystem::path& path, std::vector<uint8_t>& data);
+    void write_cooked(const std::filesystem::path& path, const PxDefaultMemoryOutputStream& data);
+    PxBase* acquire(CollisionMeshType type, const std::string& meshPath);
+
+    static uint64_t hash_source(CollisionMeshType type, const SourceData& source);
+
+    PxPhysics& m_physics;
+    PxCooking* m_cooking = nullptr;
+
+    std::mutex m_mutex;
+    // keyed by source hash, holds one PhysX reference per mesh
+    std::unordered_map<uint64_t, PxBase*> m_meshes;
+    std::unordered_map<std::string, uint64_t> m_pathHashes[static_cast<size_t>(CollisionMeshType::LAST)];
+};
+
+}  // namespace knot
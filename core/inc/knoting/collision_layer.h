@@ -0,0 +1,51 @@
+#pragma once
+
+#include <PxPhysicsAPI.h>
+#include <array>
+#include <cstdint>
+
+using namespace physx;
+
+namespace knot {
+
+using CollisionLayer = uint8_t;
+using CollisionLayerMask = uint32_t;
+
+constexpr uint32_t MAX_COLLISION_LAYERS = 32;
+constexpr CollisionLayerMask ALL_COLLISION_LAYERS = 0xFFFFFFFF;
+
+// Symmetric 32x32 table of the layers that collide, one bit mask per layer, plus the layers whose contacts are
+// reported. It is handed to the filter shader as its constant block, so it has to stay plain data.
+struct CollisionMatrix {
+    CollisionMatrix() { masks.fill(ALL_COLLISION_LAYERS); }
+
+    void set_collision(CollisionLayer a, CollisionLayer b, bool collide);
+    bool can_collide(uint32_t a, uint32_t b) const {
+        return (masks[a % MAX_COLLISION_LAYERS] & (1u << (b % MAX_COLLISION_LAYERS))) != 0;
+    }
+
+    bool is_reported(uint32_t a, uint32_t b) const {
+        return (reportMask & ((1u << (a % MAX_COLLISION_LAYERS)) | (1u << (b % MAX_COLLISION_LAYERS)))) != 0;
+    }
+
+    std::array<CollisionLayerMask, MAX_COLLISION_LAYERS> masks;
+    // contact events are only generated for pairs touching one of these layers, see Physics::subscribe_events
+    CollisionLayerMask reportMask = 0;
+};
+
+// simulation filter data holds the layer index in word0, query filter data the layer bit in word0 so the built in
+// query filtering tests it against the layer mask of a query
+PxFilterData make_simulation_filter_data(CollisionLayer layer);
+PxFilterData make_query_filter_data(CollisionLayer layer);
+
+// Kills pairs on layers that do not collide and trigger pairs against static actors before they reach the
+// narrowphase. constantBlock is the CollisionMatrix of the scene.
+PxFilterFlags collision_layer_filter_shader(PxFilterObjectAttributes attributes0,
+                                            PxFilterData filterData0,
+                                            PxFilterObjectAttributes attributes1,
+                                            PxFilterData filterData1,
+                                            PxPairFlags& pairFlags,
+                                            const void* constantBlock,
+                                            PxU32 constantBlockSize);
+
+}  // namespace knot
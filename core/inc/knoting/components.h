@@ -1,14 +1,18 @@
 #pragma once
 
 #include <knoting/camera.h>
+#include <knoting/character_controller.h>
 #include <knoting/game_object.h>
 #include <knoting/instance_mesh.h>
 #include <knoting/material.h>
 #include <knoting/mesh.h>
+#include <knoting/physics_aggregate.h>
+#include <knoting/physics_lod.h>
 #include <knoting/px_material.h>
 #include <knoting/raycast.h>
 #include <knoting/rigid_controller.h>
 #include <knoting/rigidbody.h>
 #include <knoting/shape.h>
+#include <knoting/terrain.h>
 #include <knoting/texture.h>
 #include <knoting/transform.h>
@@ -6,23 +6,30 @@
 #include <vector>
 
 #include <knoting/asset_manager.h>
+#include <knoting/engine_settings.h>
 #include <knoting/forward_renderer.h>
+#include <knoting/job_system.h>
 #include <knoting/physics.h>
 #include <knoting/subsystem.h>
+#include <knoting/system_scheduler.h>
 #include <knoting/window.h>
 
 namespace knot {
 class Engine {
    public:
-    Engine();
+    Engine(const EngineSettings& settings = EngineSettings());
     ~Engine();
 
     void update_modules();
     bool is_open();
 
+    const EngineSettings& get_settings() const { return m_settings; }
+
     std::weak_ptr<Window> get_window_module() { return m_windowModule; }
     std::weak_ptr<ForwardRenderer> get_forward_render_module() { return m_forwardRenderModule; }
     std::weak_ptr<Physics> get_physics_module() { return m_physicsModule; }
+    std::weak_ptr<JobSystem> get_job_system() { return m_jobSystem; }
+    std::weak_ptr<SystemScheduler> get_system_scheduler() { return m_systemScheduler; }
 
     static std::optional<std::reference_wrapper<Engine>> get_active_engine();
     static void set_active_engine(std::optional<std::reference_wrapper<Engine>> engine);
@@ -32,17 +39,22 @@ class Engine {
    private:
     void swap_frame();
     void reset_physics_module();
+    void add_core_systems();
 
    private:
+    EngineSettings m_settings;
     int m_windowWidth = 1024;
     int m_windowHeight = 768;
     std::string m_windowTitle = "hello knotting!";
 
    private:
+    // declared first so the workers outlive every module that may still have jobs in flight
+    std::shared_ptr<JobSystem> m_jobSystem;
     std::vector<std::shared_ptr<Subsystem>> m_engineModules;
     std::shared_ptr<Window> m_windowModule;
     std::shared_ptr<ForwardRenderer> m_forwardRenderModule;
     std::shared_ptr<Physics> m_physicsModule;
+    std::shared_ptr<SystemScheduler> m_systemScheduler;
 
     inline static std::optional<std::reference_wrapper<Engine>> s_activeEngine = std::nullopt;
     std::shared_ptr<AssetManager> m_assetManager;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <knoting/types.h>
+#include <cstdint>
+
+namespace knot {
+
+enum class PhysicsBroadPhase { SAP, MBP, ABP, LAST };
+
+struct EngineSettings {
+    // 0 picks one worker per hardware thread, minus the main thread
+    uint32_t jobWorkerCount = 0;
+    // upper bound on PhysX tasks in flight on the job system, 0 lets the solver use every job worker
+    uint32_t physicsWorkerCount = 0;
+    // fixed physics steps per second, independent of the frame rate
+    float physicsStepRate = 120.0f;
+    // steps allowed per frame before simulation time is dropped, keeps a slow frame from snowballing
+    uint32_t physicsMaxStepsPerFrame = 4;
+    // contact and trigger events kept per step, allocated once when physics starts
+    uint32_t physicsEventCapacity = 4096;
+    // fixed when the PxScene is created, MBP only sees objects inside its regions
+    PhysicsBroadPhase physicsBroadPhase = PhysicsBroadPhase::SAP;
+    // MBP regions, the world bounds split into a subdivisions x subdivisions grid on the ground plane
+    vec3 physicsWorldMin = vec3(-1000.0f);
+    vec3 physicsWorldMax = vec3(1000.0f);
+    uint32_t physicsRegionSubdivisions = 4;
+    // physics lod, dynamic bodies farther than the sleep radius from every focus are put to sleep and farther than
+    // the disable radius taken out of the simulation, 0 turns a level off
+    float physicsSleepRadius = 0.0f;
+    float physicsDisableRadius = 0.0f;
+    // steps the snapshot ring keeps for rewinds, allocated once with room for the body count
+    uint32_t physicsSnapshotFrames = 64;
+    uint32_t physicsSnapshotBodyCapacity = 1024;
+    // PxSceneFlag::eENABLE_ENHANCED_DETERMINISM on the live scene, needed for replays to match across rewinds and
+    // insertion orders at some solver cost
+    bool physicsEnhancedDeterminism = false;
+    // seconds between the debug logs of the physics statistics, 0 turns the log off
+    float physicsStatisticsLogInterval = 5.0f;
+};
+
+}  // namespace knot
@@ -4,6 +4,7 @@
 #include <knoting/light_data.h>
 #include <knoting/log.h>
 #include <knoting/mesh.h>
+#include <knoting/physics_debug.h>
 #include <knoting/shader_program.h>
 #include <knoting/subsystem.h>
 #include <knoting/texture.h>
@@ -12,6 +13,7 @@
 namespace knot {
 
 class Engine;
+class Scene;
 
 }
 namespace knot {
@@ -24,6 +26,9 @@ class ForwardRenderer : public Subsystem {
     void on_render();
     void on_post_render();
 
+    // light_packing system, fills the spotlight uniform arrays without touching bgfx
+    void pack_lights(Scene& scene);
+
     void on_awake() override;
     void on_update(double m_delta_time) override;
     void on_late_update() override;
@@ -32,12 +37,21 @@ class ForwardRenderer : public Subsystem {
     void recreate_framebuffer(uint16_t width, uint16_t height, uint16_t id = 0);
     void clear_framebuffer(uint16_t id = 0);
 
+    // drawn after the scene without clearing, so the debug geometry overlays it with the scene depth
+    static constexpr bgfx::ViewId PHYSICS_DEBUG_VIEW = 1;
+
    private:
+    // one transient buffer and one draw per primitive type
+    void render_physics_debug(const glm::mat4& view, const glm::mat4& proj);
+    void submit_debug_geometry(const std::vector<PhysicsDebugVertex>& vertices, uint64_t primitiveState);
+
     int get_window_width();
     int get_window_height();
 
     Engine& m_engine;
     LightData m_lightData;
+    components::ShaderProgram m_debugShader;
+    bool m_debugShaderLoaded = false;
 
    private:
     static constexpr uint32_t m_clearColor = 0x303030ff;
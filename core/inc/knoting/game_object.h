@@ -2,13 +2,17 @@
 
 #include <knoting/assert.h>
 #include <knoting/scene.h>
+#include <knoting/serialization.h>
+#include <knoting/string_table.h>
 #include <knoting/transform.h>
 #include <knoting/types.h>
+#include <knoting/uuid_generator.h>
 #include <cereal/cereal.hpp>
 #include <cereal/types/optional.hpp>
+#include <cereal/types/string.hpp>
 #include <cereal/types/vector.hpp>
 #include <entt/entt.hpp>
-#include <random>
+#include <array>
 
 namespace knot {
 
@@ -18,17 +22,6 @@ class Scene;
 
 namespace knot {
 
-class UUIDGenerator {
-   public:
-    UUIDGenerator();
-
-    uuid generate();
-
-   protected:
-    std::unique_ptr<uuids::uuid_random_generator> m_uuidGenerator;
-    std::mt19937 m_randomGenerator;
-};
-
 template <typename T>
 class HasOnAwake {
     typedef char one;
@@ -127,6 +120,10 @@ class GameObject {
         archive(CEREAL_NVP(this->get_id()));
     }
 
+    void set_name(const std::string& name);
+
+    static UUIDGenerator& get_uuid_generator() { return s_uuidGenerator; }
+
    protected:
     friend class Scene;
 
@@ -189,50 +186,125 @@ class Hierarchy {
 
 class Name {
    public:
-    std::string name;
+    Name(const std::string& name);
+    Name();
 
-    Name(const std::string& name) : name(name) {}
-    Name() : name(DEFAULT_NAME) {}
+    const std::string& get_name() const;
+    StringId get_id() const { return m_id; }
 
-    inline bool operator==(const Name& other) const { return name == other.name; }
-    inline bool operator!=(const Name& other) const { return name != other.name; }
+    inline bool operator==(const Name& other) const { return m_id == other.m_id; }
+    inline bool operator!=(const Name& other) const { return m_id != other.m_id; }
 
     template <class Archive>
-    void serialize(Archive& archive) {
+    void save(Archive& archive) const {
+        std::string name = get_name();
         archive(CEREAL_NVP(name));
     }
 
+    template <class Archive>
+    void load(Archive& archive) {
+        std::string name;
+        archive(CEREAL_NVP(name));
+        m_id = StringTable::intern(name);
+    }
+
    private:
     friend class knot::Scene;
 
+    StringId m_id;
+    // position inside the scene name index bucket, lets the scene unlink an entity in O(1)
+    size_t m_indexSlot = 0;
+
     static constexpr const char* DEFAULT_NAME = "GameObject";
 };
 
+// Up to 64 tags registered process wide, each entity stores the tags it carries as a bit mask
 class Tag {
    public:
     Tag(const std::string& tag = "");
+    Tag(TagMask mask);
 
-    uint16_t get_id() const;
-    std::string get_tag() const;
+    TagMask get_mask() const { return m_mask; }
+    std::vector<std::string> get_tags() const;
 
-    inline bool operator==(const Tag& other) const { return m_id == other.m_id; }
-    inline bool operator!=(const Tag& other) const { return m_id != other.m_id; }
+    bool has_tag(const std::string& tag) const;
+    bool has_all(TagMask mask) const { return (m_mask & mask) == mask; }
+    bool has_any(TagMask mask) const { return (m_mask & mask) != 0; }
 
-    static void register_tag(const std::string& tag);
+    void add_tag(const std::string& tag);
+    void remove_tag(const std::string& tag);
+
+    inline bool operator==(const Tag& other) const { return m_mask == other.m_mask; }
+    inline bool operator!=(const Tag& other) const { return m_mask != other.m_mask; }
+
+    // returns the bit for the tag, registering it if needed, or 0 once all 64 bits are taken
+    static TagMask register_tag(const std::string& tag);
     static void unregister_tag(const std::string& tag);
+    // returns 0 for tags that are not registered
+    static TagMask get_tag_mask(const std::string& tag);
     static std::vector<std::string> get_registered_tags();
 
     template <class Archive>
-    void serialize(Archive& archive) {
-        archive(this->get_registered_tags());
+    void save(Archive& archive) const {
+        std::vector<std::string> tags = get_tags();
+        archive(CEREAL_NVP(tags));
+    }
+
+    template <class Archive>
+    void load(Archive& archive) {
+        std::vector<std::string> tags;
+        if (!load_optional_nvp(archive, "tags", tags) && archive.getNodeName()) {
+            // scenes saved before tag masks hold the registered tag list, which was never loaded back either
+            archive(tags);
+            tags.clear();
+        }
+        m_mask = 0;
+        for (const auto& tag : tags) {
+            m_mask |= register_tag(tag);
+        }
+    }
+
+   protected:
+    TagMask m_mask;
+
+    static constexpr uint8_t MAX_TAGS = 64;
+
+    inline static std::map<std::string, uint8_t> s_tags;
+    inline static std::array<std::string, MAX_TAGS> s_names;
+    // bits are never handed out twice, so stale masks can not alias a newer tag
+    inline static uint8_t s_nextBit = 0;
+};
+
+// Empty tag, game objects carrying it are skipped by rendering and physics
+struct Inactive {};
+
+// Base for components that need their own game object. The Scene stores the entity when the component is emplaced,
+// so looking up the owner or a sibling component is a sparse set access instead of a storage scan.
+class OwnedComponent {
+   public:
+    entt::entity get_entity() const { return m_entity; }
+
+    // component of the same game object in the active scene, null if there is none
+    template <typename T>
+    T* get_sibling() const {
+        auto sceneOpt = Scene::get_active_scene();
+        if (!sceneOpt || m_entity == entt::null) {
+            return nullptr;
+        }
+        return sceneOpt->get().get_registry().try_get<T>(m_entity);
     }
 
    protected:
-    uint16_t m_id;
+    friend class knot::Scene;
+
+    entt::entity m_entity = entt::null;
+};
+
+class Pooled {
+   public:
+    Pooled(const std::string& pool = "") : pool(pool) {}
 
-    inline static std::map<std::string, uint16_t> s_tags;
-    inline static std::map<uint16_t, std::string> s_ids;
-    inline static uint16_t s_next_id = 1;
+    std::string pool;
 };
 
 }  // namespace components
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <entt/entt.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace knot {
+
+// Counts the outstanding jobs of a batch. Continuations attached with JobSystem::then are queued once it hits zero.
+class JobCounter {
+   public:
+    bool is_done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+   private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> m_pending = 0;
+    std::mutex m_continuationMutex;
+    std::vector<std::function<void()>> m_continuations;
+};
+
+using JobHandle = std::shared_ptr<JobCounter>;
+
+// Work stealing pool, one deque per worker. Owners pop from the back of their deque, idle workers and waiting
+// threads steal from the front of the others. Jobs submitted from a worker stay on that worker's deque.
+class JobSystem {
+   public:
+    // 0 workers picks one per hardware thread, minus the main thread
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem& other) = delete;
+    JobSystem& operator=(const JobSystem& other) = delete;
+
+    JobHandle submit(std::function<void()> job);
+    // adds the job to an existing batch
+    void submit(std::function<void()> job, const JobHandle& counter);
+    // queues the continuation once every job of the dependency batch finished
+    JobHandle then(const JobHandle& dependency, std::function<void()> continuation);
+
+    // runs queued jobs on the calling thread until the batch is done, never blocks a worker idle
+    void wait(const JobHandle& counter);
+
+    // splits [0, count) into ranges of at most grainSize and waits for all of them
+    void parallel_for(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& func);
+
+    // calls func(entity) for every entity of an entt view or group across the workers, func must only touch the
+    // components the view was built over
+    template <typename View, typename Func>
+    void parallel_each(View& view, Func func, size_t grainSize = 256) {
+        std::vector<entt::entity> entities(view.begin(), view.end());
+        parallel_for(entities.size(), grainSize, [&entities, &func](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                func(entities[i]);
+            }
+        });
+    }
+
+    uint32_t get_worker_count() const { return static_cast<uint32_t>(m_workers.size()); }
+    // index of the worker running the calling thread, -1 outside the pool
+    static int32_t get_worker_index() { return s_workerIndex; }
+
+   private:
+    struct Job {
+        std::function<void()> task;
+        JobHandle counter;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void push(Job job);
+    bool try_pop(Job& job);
+    void execute(Job& job);
+    void finish(const JobHandle& counter);
+    void worker_loop(uint32_t index);
+
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+    std::atomic<bool> m_running = true;
+    std::atomic<uint32_t> m_queuedJobs = 0;
+    std::atomic<uint32_t> m_nextQueue = 0;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+
+    inline static thread_local int32_t s_workerIndex = -1;
+};
+
+}  // namespace knot
@@ -40,6 +40,10 @@ class Mesh : public Asset {
     bgfx::VertexBufferHandle get_vertex_buffer() { return m_vbh; }
     bgfx::IndexBufferHandle get_index_buffer() { return m_ibh; }
 
+    // CPU side copies for collision cooking, indices are empty for unindexed triangle lists
+    std::vector<vec3> get_positions() const;
+    std::vector<uint32_t> get_indices() const;
+
     template <class Archive>
     void serialize(Archive& archive) {
         archive(CEREAL_NVP(m_assetType), CEREAL_NVP(m_fallbackName), CEREAL_NVP(m_fullPath), CEREAL_NVP(m_assetName),
@@ -65,6 +69,7 @@ class IndexBuffer {
     void set_index_buffer(const std::vector<unsigned int>& in_indices) { m_indices = in_indices; }
     size_t get_memory_size() { return sizeof(m_indices[0]) * m_indices.size(); }
     unsigned int& get_index_start() { return m_indices[0]; }
+    const std::vector<unsigned int>& get_indices() const { return m_indices; }
 
     template <class Archive>
     void serialize(Archive& archive) {
@@ -1,17 +1,32 @@
 #pragma once
 
+#include <knoting/collision_cooker.h>
+#include <knoting/physics_cache.h>
+#include <knoting/physics_debug.h>
+#include <knoting/physics_events.h>
+#include <knoting/physics_snapshot.h>
+#include <knoting/physics_statistics.h>
+#include <knoting/px_job_dispatcher.h>
 #include <knoting/px_variables_wrapper.h>
 #include <knoting/rigidbody.h>
+#include <knoting/scene_query.h>
 #include <knoting/subsystem.h>
+#include <characterkinematic/PxControllerManager.h>
+
+#include <algorithm>
 
 namespace knot {
 
 class Engine;
+class Scene;
 
 }
 
 namespace knot {
 
+using PhysicsEventCallback = std::function<void(const PhysicsEvent* events, size_t count)>;
+using PhysicsEventSubscription = uint32_t;
+
 class Physics : public Subsystem {
    public:
     Physics(Engine& engine);
@@ -23,21 +38,211 @@ class Physics : public Subsystem {
     void on_late_update() override;
     void on_destroy() override;
 
-    void update_info_to_transform();
+    // simulate is kicked at the start of the frame and collected in on_late_update, so the step runs on the job
+    // workers while the frame renders the poses of the previous step
+    void begin_simulation();
+    void end_simulation();
+    bool is_simulating() const { return m_simulating; }
+
+    // blend factor between the previous and the current step pose used by the transform sync, the share of a step
+    // left in the accumulator
+    float get_interpolation_alpha() const { return m_interpolationAlpha; }
+
+    // on_update runs as many fixed steps as the frame time covers, at most maxSteps
+    void set_step_rate(float stepsPerSecond);
+    void set_max_steps_per_frame(uint32_t maxSteps);
+    double get_timestep() const { return m_timestep; }
+
+    // physics_transform_sync system
+    void update_info_to_transform(Scene& scene);
+    // raycast_queries system, runs every Raycast component as one batch
+    void update_raycasts(Scene& scene);
+
+    // Batched scene queries split across the job workers. hits has to hold count entries, hits[i] receives the
+    // closest blocking hit of queries[i]. Results go straight into the caller's arrays, no per query allocation.
+    void raycast_batch(const RaycastQuery* queries, QueryHit* hits, size_t count);
+    void sweep_batch(const SweepQuery* queries, QueryHit* hits, size_t count);
+    void overlap_batch(const OverlapQuery* queries, QueryHit* hits, size_t count);
+
+    // Inserts actors that are not in a scene yet in one call. A pruning structure builds the scene query trees for the
+    // whole batch up front, so the broadphase and query trees are not rebuilt per actor.
+    void add_actors(PxRigidActor* const* actors, size_t count);
+
+    // Layers collide with every layer by default. Turning a pair off kills it in the filter shader before the
+    // narrowphase, the change applies to pairs that already exist as well.
+    void set_layer_collision(CollisionLayer a, CollisionLayer b, bool collide);
+    const CollisionMatrix& get_collision_matrix() const { return m_collisionMatrix; }
+
+    // Dynamic bodies beyond sleepRadius of every focus (editor camera and PhysicsLodFocus game objects) are kept
+    // asleep, beyond disableRadius they leave the simulation. Either way they get their velocities back when they
+    // return. 0 turns a level off. Runs before each frame's steps, the far bodies then cost the solver nothing.
+    void set_lod_radii(float sleepRadius, float disableRadius);
+    float get_lod_sleep_radius() const { return m_lodSleepRadius; }
+    float get_lod_disable_radius() const { return m_lodDisableRadius; }
+
+    // Stores poses, velocities and sleep state of every dynamic body and the foot position of every character
+    // controller after the latest step in the snapshot ring, plus the ECS state that goes with them. full also keeps
+    // the whole PxScene as a PxSerialization binary collection for export_snapshot. Waits for a running step. Returns
+    // the step to restore.
+    uint64_t capture_snapshot(bool full = false);
+    // Rewinds every body and controller still alive to the snapshot, later snapshots are dropped. Only writes into
+    // existing actors, so it costs about as much as the capture. false once the step left the ring.
+    bool restore_snapshot(uint64_t step);
+    // writes the binary collection of a full capture, loadable with PxSerialization::createCollectionFromBinary
+    bool export_snapshot(uint64_t step, const std::string& path) const;
+    // Serializes the scene into a local snapshot and runs the steps twice, each time in a scratch scene deserialized
+    // from it with enhanced determinism, then compares the poses. The live scene, characters and the snapshot ring
+    // are not touched.
+    PhysicsDeterminismReport check_determinism(uint32_t steps);
+    // fixed steps simulated so far, rewound by restore_snapshot
+    uint64_t get_step_index() const { return m_stepIndex; }
+    const PhysicsSnapshotRing& get_snapshots() const { return *m_snapshots; }
+
+    // counters and timings of the latest step, see set_statistics_log_interval for the averages
+    const PhysicsStatistics& get_statistics() const { return m_statistics; }
+    // logs the step averages and peaks at debug level every interval seconds, 0 turns the log off
+    void set_statistics_log_interval(float seconds) { m_statisticsLogInterval = std::max(seconds, 0.0f); }
+
+    // Turns the PhysX debug visualisation on, collision shapes are drawn by default and set_debug_parameter adds more
+    // (contacts, aabbs, joints, ...). The geometry of the newest step is copied once per frame that stepped.
+    void set_debug_visualization(bool enabled);
+    void set_debug_parameter(PxVisualizationParameter::Enum parameter, float value);
+    bool is_debug_visualization_enabled() const { return m_debugVisualization; }
+    // read by the forward renderer while the next step simulates, only written between steps
+    const std::vector<PhysicsDebugVertex>& get_debug_lines() const { return m_debugLines; }
+    const std::vector<PhysicsDebugVertex>& get_debug_triangles() const { return m_debugTriangles; }
+
+    // MBP only, replaces the broadphase regions with a grid over the bounds, existing objects are sorted into it
+    void set_broadphase_regions(const vec3& worldMin, const vec3& worldMax, uint32_t subdivisions);
+
+    // The callback receives the events of the fixed steps that involve one of the layers. They are delivered from
+    // on_update after each step it runs and from on_late_update, never from inside another physics call, so
+    // callbacks may change the registry. Contacts are only reported for subscribed layers, triggers always are.
+    // Callbacks must not subscribe or unsubscribe.
+    PhysicsEventSubscription subscribe_events(CollisionLayerMask layers, PhysicsEventCallback callback);
+    void unsubscribe_events(PhysicsEventSubscription subscription);
+
+    // actors carry their entity in userData so PhysX results map back to the registry without a lookup
+    static void set_actor_entity(PxActor& actor, entt::entity entity);
+    // call before an actor leaves the scene for good, its lost contacts are still reported with its entity
+    void note_removed_actor(const PxRigidActor& actor);
+    static entt::entity get_actor_entity(const PxActor& actor);
+
+    // engine owned singletons for the physics components, null while no physics module is awake. Components keep raw
+    // PhysX pointers and reach the shared objects through these instead of holding references of their own.
+    static Physics* get_instance() { return s_instance; }
+    static PxPhysics* get_px_physics() { return s_instance ? s_instance->m_Physics->get() : nullptr; }
+    static PxScene* get_px_scene() { return s_instance ? s_instance->m_Scene->get() : nullptr; }
+    static PhysicsCache* get_physics_cache() { return s_instance ? s_instance->m_cache.get() : nullptr; }
+    static CollisionCooker* get_collision_cooker() { return s_instance ? s_instance->m_cooker.get() : nullptr; }
+    static PxControllerManager* get_controller_manager() {
+        return s_instance ? s_instance->m_controllerManager : nullptr;
+    }
+    // shared by every character move, obstacles added here block all controllers without being scene actors
+    static PxObstacleContext* get_obstacle_context() { return s_instance ? s_instance->m_obstacles : nullptr; }
 
     std::weak_ptr<PxScene_ptr_wrapper> get_active_Scene() { return m_Scene; }
     std::weak_ptr<PxPhysics_ptr_wrapper> get_physics() { return m_Physics; }
+    std::weak_ptr<PhysicsCache> get_cache() { return m_cache; }
+    std::weak_ptr<CollisionCooker> get_cooker() { return m_cooker; }
     PxVec3 get_gravity() { return m_gravity; }
 
     void set_gravity(PxVec3 gravity);
 
    private:
+    void record_active_actors();
+    // releases the PhysX objects the scene components own while PxPhysics still exists, the components stay behind
+    // empty so nothing reaches into a released module later
+    void release_scene_objects();
+    // the whole PxScene as a PxSerialization binary collection
+    bool serialize_scene(std::vector<uint8_t>& bytes);
+    // deserializes a binary collection into a scene of its own, steps it and returns the poses of its dynamic actors
+    bool step_scratch_scene(const std::vector<uint8_t>& collection,
+                            uint32_t steps,
+                            std::vector<PxTransform>& poses);
+    // moves every CharacterController by one fixed step, right before simulate
+    void move_controllers();
+    void update_lod(Scene& scene);
+    void dispatch_events();
+    void record_statistics(double fetchResultsMs);
+    void log_statistics(double deltaTime);
+    // the PxScene render buffer is only valid between fetchResults and the next simulate
+    void capture_debug_geometry();
+    void update_report_mask();
+    // pushes the collision matrix to the scene and filters every existing pair again
+    void refresh_filtering();
+    static void fill_hit(QueryHit& hit, const PxActorShape& block);
+
     Engine& m_engine;
     std::shared_ptr<PxFoundation_ptr_wrapper> m_Foundation;
     std::shared_ptr<PxPhysics_ptr_wrapper> m_Physics;
-    std::shared_ptr<PxDispatcher_ptr_wrapper> m_Dispatcher;
+    std::shared_ptr<PhysicsCache> m_cache;
+    std::shared_ptr<CollisionCooker> m_cooker;
+    std::shared_ptr<PxJobDispatcher> m_Dispatcher;
     std::shared_ptr<PxScene_ptr_wrapper> m_Scene;
     PxVec3 m_gravity;
+    CollisionMatrix m_collisionMatrix;
+
+    struct EventSubscriber {
+        PhysicsEventSubscription id;
+        CollisionLayerMask layers;
+        PhysicsEventCallback callback;
+        // events of the step matching the layers, sized to the buffer capacity up front
+        std::vector<PhysicsEvent> matching;
+    };
+
+    std::vector<PxU32> m_broadPhaseRegions;
+
+    PxControllerManager* m_controllerManager = nullptr;
+    PxObstacleContext* m_obstacles = nullptr;
+
+    PxSerializationRegistry* m_serializationRegistry = nullptr;
+    std::shared_ptr<PhysicsSnapshotRing> m_snapshots;
+    uint64_t m_stepIndex = 0;
+
+    float m_lodSleepRadius = 0.0f;
+    float m_lodDisableRadius = 0.0f;
+    std::vector<vec3> m_lodFoci;
+
+    std::shared_ptr<PhysicsEventBuffer> m_events;
+    std::vector<EventSubscriber> m_eventSubscribers;
+    PhysicsEventSubscription m_nextSubscription = 1;
+
+    bool m_debugVisualization = false;
+    bool m_debugGeometryStale = false;
+    std::vector<PhysicsDebugVertex> m_debugLines;
+    std::vector<PhysicsDebugVertex> m_debugTriangles;
+
+    PhysicsStatistics m_statistics;
+    PhysicsStepTimer m_stepTimer;
+    float m_statisticsLogInterval = 0.0f;
+    double m_statisticsTime = 0.0;
+    // summed over the steps since the last log
+    uint32_t m_statisticsSteps = 0;
+    double m_statisticsSimulateMs = 0.0;
+    double m_statisticsFetchMs = 0.0;
+    double m_statisticsStepMs = 0.0;
+    double m_statisticsPeakStepMs = 0.0;
+    uint64_t m_statisticsContactPairs = 0;
+
+    bool m_simulating = false;
+    double m_timestep = 1.0 / 120.0;
+    double m_accumulator = 0.0;
+    uint32_t m_maxStepsPerFrame = 4;
+    float m_interpolationAlpha = 1.0f;
+
+    // moved (or came to rest) in the most recent step, synced every frame while the alpha sweeps over that step
+    std::vector<entt::entity> m_lastStepEntities;
+    // sorted, moved in the most recent step
+    std::vector<entt::entity> m_lastStepMoved;
+    // touched by earlier steps that have not reached the transforms yet
+    std::vector<entt::entity> m_pendingSyncEntities;
+
+    std::vector<entt::entity> m_raycastEntities;
+    std::vector<RaycastQuery> m_raycastQueries;
+    std::vector<QueryHit> m_raycastHits;
+
+    inline static Physics* s_instance = nullptr;
 };
 
 }  // namespace knot
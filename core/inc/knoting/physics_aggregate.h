@@ -0,0 +1,54 @@
+#pragma once
+
+#include <knoting/components.h>
+#include <knoting/px_variables_wrapper.h>
+#include <vector>
+
+namespace knot {
+namespace components {
+
+// Groups the rigidbodies of a hierarchy subtree (this game object and all of its descendants) into one PxAggregate,
+// so a vehicle or ragdoll is a single broadphase entry. Rigidbodies added to the subtree later join on rebuild.
+class PhysicsAggregate : public OwnedComponent {
+   public:
+    PhysicsAggregate(bool selfCollision = false);
+    PhysicsAggregate(const PhysicsAggregate& other) = delete;
+    PhysicsAggregate& operator=(const PhysicsAggregate& other) = delete;
+    PhysicsAggregate(PhysicsAggregate&& other) noexcept;
+    PhysicsAggregate& operator=(PhysicsAggregate&& other) noexcept;
+
+    void on_awake();
+    void on_load();
+    void on_destroy();
+
+    // collects the subtree actors again, every actor leaves the scene and enters the aggregate
+    void rebuild();
+
+    // parts of one compound usually are jointed and should not collide with each other
+    void set_self_collision(bool selfCollision);
+    bool get_self_collision() const { return m_selfCollision; }
+    PxAggregate* get_aggregate() const { return m_aggregate; }
+
+    template <class Archive>
+    void save(Archive& archive) const {
+        archive(CEREAL_NVP(m_selfCollision));
+    }
+
+    template <class Archive>
+    void load(Archive& archive) {
+        archive(CEREAL_NVP(m_selfCollision));
+    }
+
+    // PhysX limit on the actors of one aggregate
+    static constexpr uint32_t MAX_AGGREGATE_ACTORS = 128;
+
+   protected:
+    void collect_actors(std::vector<PxRigidActor*>& actors) const;
+    void release_aggregate();
+
+    PxAggregate* m_aggregate = nullptr;
+    bool m_selfCollision = false;
+};
+
+}  // namespace components
+}  // namespace knot
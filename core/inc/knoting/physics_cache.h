@@ -0,0 +1,54 @@
+#pragma once
+
+#include <knoting/collision_layer.h>
+#include <knoting/px_variables_wrapper.h>
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+namespace knot {
+
+// geometry parameters, material, local pose, layer and trigger flag packed into words without padding, so keys
+// compare and hash raw
+using PhysicsCacheKey = std::array<uint32_t, 24>;
+
+struct PhysicsCacheKeyHash {
+    size_t operator()(const PhysicsCacheKey& key) const;
+};
+
+// Shares PxMaterial and PxShape instances between every component asking for the same parameters. The cache only
+// holds weak references, an entry goes away with its last user. Shapes are created non exclusive so one PxShape can
+// be attached to any number of actors, they must not be edited in place, acquire a new one instead.
+class PhysicsCache {
+   public:
+    explicit PhysicsCache(std::shared_ptr<PxPhysics_ptr_wrapper> physics);
+
+    std::shared_ptr<PxMaterial_ptr_wrapper> acquire_material(float staticFriction,
+                                                             float dynamicFriction,
+                                                             float restitution);
+    // the layer goes into the simulation and query filter data, triggers are left out of simulation and queries
+    std::shared_ptr<PxShape_ptr_wrapper> acquire_shape(const PxGeometry& geometry,
+                                                       PxMaterial& material,
+                                                       const PxTransform& localPose = PxTransform(PxIdentity),
+                                                       CollisionLayer layer = 0,
+                                                       bool isTrigger = false);
+
+    // drops entries whose objects were released, lookups do this lazily for the keys they touch
+    void collect_garbage();
+
+    size_t get_material_count() const { return m_materials.size(); }
+    size_t get_shape_count() const { return m_shapes.size(); }
+
+   private:
+    static PhysicsCacheKey make_shape_key(const PxGeometry& geometry,
+                                          const PxMaterial& material,
+                                          const PxTransform& localPose,
+                                          CollisionLayer layer,
+                                          bool isTrigger);
+
+    std::shared_ptr<PxPhysics_ptr_wrapper> m_physics;
+    std::unordered_map<PhysicsCacheKey, std::weak_ptr<PxMaterial_ptr_wrapper>, PhysicsCacheKeyHash> m_materials;
+    std::unordered_map<PhysicsCacheKey, std::weak_ptr<PxShape_ptr_wrapper>, PhysicsCacheKeyHash> m_shapes;
+};
+
+}  // namespace knot
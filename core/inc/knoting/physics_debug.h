@@ -0,0 +1,25 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+
+namespace knot {
+
+// Vertex of the physics debug geometry, lines are vertex pairs and triangles vertex triples
+struct PhysicsDebugVertex {
+    float m_x;
+    float m_y;
+    float m_z;
+    uint32_t m_abgr;
+
+    static void init() {
+        s_layout.begin()
+            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+            .end();
+    }
+
+    inline static bgfx::VertexLayout s_layout;
+};
+
+}  // namespace knot
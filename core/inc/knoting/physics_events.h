@@ -0,0 +1,72 @@
+#pragma once
+
+#include <knoting/collision_layer.h>
+#include <knoting/types.h>
+#include <entt/entt.hpp>
+#include <vector>
+
+namespace knot {
+
+enum class PhysicsEventType : uint8_t { ContactBegin, ContactEnd, TriggerEnter, TriggerExit, LAST };
+
+// One contact or trigger pair of a step. Contacts carry the average contact point and the summed impulse, triggers
+// leave both at zero. For triggers entityA is the trigger.
+struct PhysicsEvent {
+    PhysicsEventType type = PhysicsEventType::ContactBegin;
+    CollisionLayer layerA = 0;
+    CollisionLayer layerB = 0;
+    entt::entity entityA = entt::null;
+    entt::entity entityB = entt::null;
+    vec3 point = vec3(0.0f);
+    vec3 impulse = vec3(0.0f);
+};
+
+// Collects the contact and trigger reports of a step into storage allocated once up front. The callbacks run on the
+// thread calling fetchResults, events past the capacity are dropped and counted.
+class PhysicsEventBuffer : public PxSimulationEventCallback {
+   public:
+    explicit PhysicsEventBuffer(size_t capacity);
+
+    void onContact(const PxContactPairHeader& pairHeader, const PxContactPair* pairs, PxU32 nbPairs) override;
+    void onTrigger(PxTriggerPair* pairs, PxU32 count) override;
+    void onConstraintBreak(PxConstraintInfo* constraints, PxU32 count) override {}
+    void onWake(PxActor** actors, PxU32 count) override {}
+    void onSleep(PxActor** actors, PxU32 count) override {}
+    void onAdvance(const PxRigidBody* const* bodyBuffer, const PxTransform* poseBuffer, const PxU32 count) override {}
+
+    const PhysicsEvent* get_events() const { return m_events.data(); }
+    size_t get_count() const { return m_count; }
+    size_t get_capacity() const { return m_events.size(); }
+    size_t get_dropped() const { return m_dropped; }
+
+    void clear();
+
+    // PhysX reports the lost contacts of a removed actor in the next step but the actor must not be read by then, so
+    // whoever removes it notes its entity and layer first
+    void note_removed_actor(const PxActor* actor, entt::entity entity, CollisionLayer layer);
+    // after the step that reported them
+    void clear_removed_actors() { m_removedActors.clear(); }
+
+   private:
+    struct RemovedActor {
+        const PxActor* actor;
+        entt::entity entity;
+        CollisionLayer layer;
+    };
+
+    PhysicsEvent* push();
+    // entity and layer of one side of a pair, from the noted removals when the actor or shape is gone
+    bool resolve(const PxActor* actor,
+                 const PxShape* shape,
+                 bool actorRemoved,
+                 bool shapeRemoved,
+                 entt::entity& entity,
+                 CollisionLayer& layer) const;
+
+    std::vector<PhysicsEvent> m_events;
+    size_t m_count = 0;
+    size_t m_dropped = 0;
+    std::vector<RemovedActor> m_removedActors;
+};
+
+}  // namespace knot
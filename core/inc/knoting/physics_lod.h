@@ -0,0 +1,24 @@
+#pragma once
+
+#include <PxPhysicsAPI.h>
+
+using namespace physx;
+
+namespace knot {
+namespace components {
+
+// Marks a game object the physics lod measures distances from, next to the editor camera. Players and other points
+// of interest carry it so bodies around them keep simulating.
+struct PhysicsLodFocus {};
+
+// Velocities of a body the physics lod put to sleep or took out of the simulation, both zero them. They are given back
+// once the body is close again.
+struct PhysicsLodParked {
+    PxVec3 linearVelocity = PxVec3(0.0f);
+    PxVec3 angularVelocity = PxVec3(0.0f);
+    // out of the simulation rather than asleep
+    bool disabled = false;
+};
+
+}  // namespace components
+}  // namespace knot
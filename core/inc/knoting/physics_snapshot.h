@@ -0,0 +1,91 @@
+#pragma once
+
+#include <PxPhysicsAPI.h>
+#include <characterkinematic/PxController.h>
+#include <entt/entt.hpp>
+#include <cstdint>
+#include <vector>
+
+using namespace physx;
+
+namespace knot {
+
+constexpr uint8_t BODY_SLEEPING = 1 << 0;
+constexpr uint8_t BODY_SIMULATION_DISABLED = 1 << 1;
+constexpr uint8_t BODY_KINEMATIC = 1 << 2;
+// parked by the physics lod, the lod velocities hold what PhysicsLodParked stored
+constexpr uint8_t BODY_LOD_PARKED = 1 << 3;
+
+// Everything a dynamic body needs to continue from a step. The actor pointer is only compared against the entity's
+// current actor on restore, bodies rebuilt or destroyed since the capture are skipped.
+struct PhysicsBodyState {
+    entt::entity entity = entt::null;
+    const PxRigidActor* actor = nullptr;
+    PxTransform pose = PxTransform(PxIdentity);
+    PxVec3 linearVelocity = PxVec3(0.0f);
+    PxVec3 angularVelocity = PxVec3(0.0f);
+    PxVec3 lodLinearVelocity = PxVec3(0.0f);
+    PxVec3 lodAngularVelocity = PxVec3(0.0f);
+    uint8_t flags = 0;
+};
+
+// A character controller is kinematic, its foot position and the vertical speed it carries between moves are its
+// whole state. Controllers recreated since the capture are skipped like bodies.
+struct PhysicsControllerState {
+    entt::entity entity = entt::null;
+    const PxController* controller = nullptr;
+    PxExtendedVec3 footPosition = PxExtendedVec3(0.0, 0.0, 0.0);
+    float verticalSpeed = 0.0f;
+};
+
+struct PhysicsSnapshot {
+    // index of the fixed step the snapshot was taken after
+    uint64_t step = 0;
+    double accumulator = 0.0;
+    std::vector<PhysicsBodyState> bodies;
+    std::vector<PhysicsControllerState> controllers;
+    // PxSerialization binary collection of the whole scene, only filled by a full capture
+    std::vector<uint8_t> collection;
+
+    void capture_bodies(entt::registry& registry);
+    // writes poses, velocities and sleep state back to the actors and transforms, returns the bodies restored
+    size_t restore_bodies(entt::registry& registry) const;
+    void capture_controllers(entt::registry& registry);
+    // returns the controllers restored
+    size_t restore_controllers(entt::registry& registry) const;
+};
+
+// result of Physics::check_determinism, errors are the largest over every body
+struct PhysicsDeterminismReport {
+    uint32_t steps = 0;
+    size_t bodies = 0;
+    // bodies whose poses differ at all between the two runs
+    size_t mismatches = 0;
+    float maxPositionError = 0.0f;
+    float maxRotationError = 0.0f;
+};
+
+// Fixed number of snapshots allocated up front, the newest overwrites the oldest. Body arrays keep their capacity
+// between captures so a capture only allocates once a scene grows past the reserved body count.
+class PhysicsSnapshotRing {
+   public:
+    PhysicsSnapshotRing(size_t frameCount, size_t bodyCapacity);
+
+    PhysicsSnapshot& push(uint64_t step);
+    // null once the step fell out of the ring
+    const PhysicsSnapshot* find(uint64_t step) const;
+    const PhysicsSnapshot* latest() const;
+    // drops every snapshot after the step, a restored timeline overwrites them
+    void truncate_after(uint64_t step);
+    void clear();
+
+    size_t get_size() const { return m_size; }
+    size_t get_capacity() const { return m_frames.size(); }
+
+   private:
+    std::vector<PhysicsSnapshot> m_frames;
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
+
+}  // namespace knot
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <PxPhysicsAPI.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+using namespace physx;
+
+namespace knot {
+
+// Counters of the latest fixed step, copied out of PxSimulationStatistics, and the wall time it took
+struct PhysicsStatistics {
+    uint32_t activeBodies = 0;
+    uint32_t activeKinematicBodies = 0;
+    uint32_t dynamicBodies = 0;
+    uint32_t staticBodies = 0;
+    uint32_t activeConstraints = 0;
+    // pairs the narrowphase ran on, and the ones of those that touch
+    uint32_t contactPairs = 0;
+    uint32_t touchingPairs = 0;
+    uint32_t newTouches = 0;
+    uint32_t lostTouches = 0;
+    uint32_t broadPhaseAdds = 0;
+    uint32_t broadPhaseRemoves = 0;
+
+    // milliseconds, simulate is the kick on the calling thread, fetchResults the time the caller blocked on the workers
+    double simulateMs = 0.0;
+    double fetchResultsMs = 0.0;
+    // milliseconds from the start of simulate until the workers finished the step, whatever the frame did meanwhile
+    double stepMs = 0.0;
+
+    // since the physics module started, rewinds do not count down
+    uint64_t steps = 0;
+};
+
+// Completion task handed to PxScene::simulate, it runs on a worker as soon as the step is done and keeps the time.
+// fetchResults can return before it ran, the caller falls back to its own clock then.
+class PhysicsStepTimer : public PxLightCpuTask {
+   public:
+    // arms the task and starts the clock, false while the previous step's task has not run yet
+    bool start(PxTaskManager& taskManager);
+    // milliseconds since start, up to the completion if the task already ran
+    double get_step_ms() const;
+    bool is_running() const { return m_running.load(std::memory_order_acquire); }
+
+    void run() override;
+    void release() override;
+    const char* getName() const override { return "knoting.physics_step_timer"; }
+
+   private:
+    std::chrono::high_resolution_clock::time_point m_start;
+    std::chrono::high_resolution_clock::time_point m_finish;
+    std::atomic<bool> m_running = false;
+    std::atomic<bool> m_finished = false;
+};
+
+}  // namespace knot
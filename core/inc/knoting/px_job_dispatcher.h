@@ -0,0 +1,30 @@
+#pragma once
+
+#include <knoting/job_system.h>
+#include <knoting/px_variables_wrapper.h>
+#include <deque>
+#include <mutex>
+
+namespace knot {
+
+// Runs PhysX tasks on the engine job system instead of a private PhysX thread pool. At most workerCount tasks are
+// in flight at once, the rest wait in submission order until a slot frees up.
+class PxJobDispatcher : public PxCpuDispatcher {
+   public:
+    PxJobDispatcher(JobSystem& jobSystem, uint32_t workerCount);
+
+    void submitTask(PxBaseTask& task) override;
+    uint32_t getWorkerCount() const override { return m_workerCount; }
+
+   private:
+    void run_tasks(PxBaseTask* task);
+
+    JobSystem& m_jobSystem;
+    uint32_t m_workerCount;
+
+    std::mutex m_pendingMutex;
+    std::deque<PxBaseTask*> m_pending;
+    uint32_t m_inFlight = 0;
+};
+
+}  // namespace knot
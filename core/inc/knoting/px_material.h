@@ -1,13 +1,13 @@
 #pragma once
 #include <knoting/components.h>
+#include <knoting/physics_cache.h>
 #include <knoting/px_variables_wrapper.h>
 
 namespace knot {
 namespace components {
-class PhysicsMaterial {
+class PhysicsMaterial : public OwnedComponent {
    public:
     PhysicsMaterial();
-    ~PhysicsMaterial();
 
     void on_awake();
     void on_destroy();
@@ -17,9 +17,17 @@ class PhysicsMaterial {
     float get_static_friction() { return m_material->get()->getStaticFriction(); }
     float get_restitution() { return m_material->get()->getRestitution(); }
 
-    void set_dynamic_friction(float dynamic_friction) { m_material->get()->setDynamicFriction(dynamic_friction); }
-    void set_static_friction(float static_friction) { m_material->get()->setStaticFriction(static_friction); }
-    void set_restitution(float restitution) { m_material->get()->setRestitution(restitution); }
+    // PxMaterials are shared through the physics cache, changing a value acquires the matching material instead of
+    // editing the shared one
+    void set_dynamic_friction(float dynamic_friction) {
+        set_px_material(get_static_friction(), dynamic_friction, get_restitution());
+    }
+    void set_static_friction(float static_friction) {
+        set_px_material(static_friction, get_dynamic_friction(), get_restitution());
+    }
+    void set_restitution(float restitution) {
+        set_px_material(get_static_friction(), get_dynamic_friction(), restitution);
+    }
     void set_px_material(float staticFriction, float dynamicFriction, float restitution);
 
     template <class Archive>
@@ -40,7 +48,6 @@ class PhysicsMaterial {
 
    protected:
     std::shared_ptr<PxMaterial_ptr_wrapper> m_material;
-    std::shared_ptr<PxPhysics_ptr_wrapper> m_physics;
 };
 }  // namespace components
 }  // namespace knot
@@ -65,72 +65,6 @@ class PxFoundation_ptr_wrapper {
    private:
     PxFoundation* m_foundation;
 };
-class PxDispatcher_ptr_wrapper {
-   public:
-    PxDispatcher_ptr_wrapper(PxDefaultCpuDispatcher* dispatcher = nullptr) : m_dispatcher(dispatcher) {}
-    ~PxDispatcher_ptr_wrapper() { clean(); }
-    void set(PxDefaultCpuDispatcher* dispatcher) {
-        clean();
-        m_dispatcher = dispatcher;
-    }
-
-    PxDefaultCpuDispatcher* get() { return m_dispatcher; }
-
-    void clean() {
-        if (m_dispatcher) {
-            m_dispatcher->release();
-            m_dispatcher = nullptr;
-        }
-    }
-
-   private:
-    PxDefaultCpuDispatcher* m_dispatcher;
-};
-
-class PxDynamic_ptr_wrapper {
-   public:
-    PxDynamic_ptr_wrapper(PxRigidDynamic* dynamic = nullptr) : m_dynamic(dynamic) {}
-    ~PxDynamic_ptr_wrapper() { clean(); }
-    void set(PxRigidDynamic* dynamic) {
-        clean();
-        m_dynamic = dynamic;
-    }
-
-    PxRigidDynamic* get() { return m_dynamic; }
-
-    void clean() {
-        if (m_dynamic) {
-            m_dynamic->release();
-            m_dynamic = nullptr;
-        }
-    }
-
-   private:
-    PxRigidDynamic* m_dynamic;
-};
-
-class PxStatic_ptr_wrapper {
-   public:
-    PxStatic_ptr_wrapper(PxRigidStatic* s = nullptr) : m_static(s) {}
-    ~PxStatic_ptr_wrapper() { clean(); }
-    void set(PxRigidStatic* s) {
-        clean();
-        m_static = s;
-    }
-
-    PxRigidStatic* get() { return m_static; }
-
-    void clean() {
-        if (m_static) {
-            m_static->release();
-            m_static = nullptr;
-        }
-    }
-
-   private:
-    PxRigidStatic* m_static;
-};
-
 class PxShape_ptr_wrapper {
    public:
     PxShape_ptr_wrapper(PxShape* shape = nullptr) : m_shape(shape) {}
@@ -1,11 +1,12 @@
 #pragma once
 #include <knoting/components.h>
 #include <knoting/px_variables_wrapper.h>
+#include <knoting/scene_query.h>
 #include <knoting/types.h>
 
 namespace knot {
 namespace components {
-class Raycast {
+class Raycast : public OwnedComponent {
    public:
     Raycast();
     ~Raycast();
@@ -13,26 +14,35 @@ class Raycast {
     void on_awake();
     void on_destroy();
 
+    // issues a single query right away, the raycast_queries system batches every component once per frame
     void raycast();
 
+    RaycastQuery get_query() const;
+    void set_hit(const QueryHit& hit);
+
     vec3 get_origin();
     vec3 get_unitDir();
     float get_maxDistance() {
-        if (m_isHit) {
+        if (m_hit.isHit) {
             return m_maxDistance;
         }
         return std::numeric_limits<float>::max();
     }
-    bool get_is_hit() { return m_isHit; }
+    bool get_is_hit() { return m_hit.isHit; }
     vec3 get_hit_position();
     vec3 get_hit_normal();
     float get_hit_distance();
-    std::weak_ptr<PxShape_ptr_wrapper> get_hit_shape();
+    // not owned, valid while the hit actor stays in the scene
+    PxShape* get_hit_shape();
+    entt::entity get_hit_entity() { return m_hit.entity; }
 
     void set_origin(const vec3& origin);
     void set_unit_dir(const vec3& unitDir);
     void set_max_distance(const float& maxDistance);
     void set_raycast(const vec3& origin, const vec3& unitDir, const float& maxDistance);
+    // only shapes on these layers are hit
+    void set_layer_mask(CollisionLayerMask layerMask) { m_layerMask = layerMask; }
+    CollisionLayerMask get_layer_mask() const { return m_layerMask; }
 
     PxVec3 get_position_from_transform();
 
@@ -43,12 +53,11 @@ class Raycast {
     void load(Archive& archive);
 
    protected:
-    std::shared_ptr<PxScene_ptr_wrapper> m_scene;
     PxVec3 m_origin;
     PxVec3 m_unitDir;
     PxReal m_maxDistance;
-    bool m_isHit;
-    PxRaycastBuffer m_hit;
+    CollisionLayerMask m_layerMask = ALL_COLLISION_LAYERS;
+    QueryHit m_hit;
 };
 
 }  // namespace components
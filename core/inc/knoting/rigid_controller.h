@@ -4,16 +4,17 @@
 
 namespace knot {
 namespace components {
-class RigidController {
+// Drives the dynamic actor of the RigidBody on the same game object. The actor is looked up on every call, the
+// RigidBody may release or rebuild it at any time, calls without a dynamic actor do nothing.
+class RigidController : public OwnedComponent {
    public:
     RigidController();
-    ~RigidController();
 
     void on_awake();
     void on_destroy();
     void on_load();
 
-    std::weak_ptr<PxDynamic_ptr_wrapper> get_dynamic();
+    PxRigidDynamic* get_dynamic() const;
     bool get_is_kinematic();
     bool get_is_awake();
     float get_mass();
@@ -22,7 +23,6 @@ class RigidController {
     vec3 get_angular_velocity();
     vec3 get_linear_velocity();
 
-    void set_dynamic(std::shared_ptr<PxDynamic_ptr_wrapper> dynamic);
     void set_kinematic(const bool& isKinematic);
     void set_mass(const float& mass);
     void set_angular_damping(const float& angDamp);
@@ -46,15 +46,13 @@ class RigidController {
     void load(Archive& archive) {
         bool isAwake, isKinematic;
         archive(CEREAL_NVP(isAwake), CEREAL_NVP(isKinematic));
-        on_awake();
         m_isAwake = isAwake;
         m_isKinematic = isKinematic;
     }
 
    protected:
-    std::shared_ptr<PxDynamic_ptr_wrapper> m_dynamic;
-    bool m_isAwake;
-    bool m_isKinematic;
+    bool m_isAwake = true;
+    bool m_isKinematic = false;
 };
 
 }  // namespace components
@@ -10,7 +10,11 @@ using namespace physx;
 namespace knot {
 namespace components {
 
-class RigidBody {
+enum class RigidBodyType : uint8_t { None, Static, Dynamic };
+
+// Plain data, the actor is a raw PhysX pointer tagged with its type and the PxPhysics/PxScene come from the Physics
+// singletons. The component owns its actor, on_destroy removes and releases it (Scene calls it for every removal).
+class RigidBody : public OwnedComponent {
     // fllow this way
     // set physics and scene
     // set material(already defalut)
@@ -18,16 +22,24 @@ class RigidBody {
 
    public:
     RigidBody();
-    ~RigidBody();
+    // the actor is owned, a copy would release it twice
+    RigidBody(const RigidBody& other) = delete;
+    RigidBody& operator=(const RigidBody& other) = delete;
+    // the actor goes with the component, the moved from component is left empty
+    RigidBody(RigidBody&& other) noexcept;
+    RigidBody& operator=(RigidBody&& other) noexcept;
 
-    void on_awake();
+    // builds the actor but leaves inserting it to the caller, see Scene::load_scene_from_stream
     void on_load();
     void on_destroy();
 
     vec3 get_position();
     quat get_rotation();
-    std::weak_ptr<PxDynamic_ptr_wrapper> get_dynamic();
-    std::weak_ptr<PxStatic_ptr_wrapper> get_static();
+    RigidBodyType get_type() const { return m_type; }
+    bool is_dynamic() const { return m_type == RigidBodyType::Dynamic; }
+    // null unless the actor is of that type
+    PxRigidDynamic* get_dynamic() const;
+    PxRigidStatic* get_static() const;
 
     // could use after creat rigid
     void set_transform(const vec3& position, const quat& rotation = quat());
@@ -35,12 +47,25 @@ class RigidBody {
     void set_rotation(const quat& rotation);
     //
 
+    // Keeps the actor in the scene but takes it out of the simulation, used to park pooled game objects
+    void set_simulation_enabled(bool enabled);
+
+    // poses of the two most recent physics steps, the transform sync blends between them
+    void record_pose();
+    void reset_pose_history();
+    vec3 get_interpolated_position(float alpha) const;
+    quat get_interpolated_rotation(float alpha) const;
+
     void create_actor(bool isDynamic, const float& mass = 0);
-    void set_shape(std::shared_ptr<PxShape_ptr_wrapper> shape) { m_shape = shape; }
+    // creates the actor without adding it to the PxScene, for batched insertion through Physics::add_actors
+    void build_actor(bool isDynamic, const float& mass = 0);
+    PxRigidActor* get_actor() const { return m_actor; }
+    // detaches the current shape from the actor and attaches the new one, mass and inertia follow the new shape
+    void replace_shape(PxShape& shape);
 
     PxVec3 get_position_from_transform();
     PxQuat get_rotation_from_transform();
-    std::shared_ptr<PxShape_ptr_wrapper> get_shape_from_shape();
+    PxShape* get_shape_from_shape();
     static vec3 PxVec3_to_vec3(PxVec3 v);
     static PxVec3 vec3_to_PxVec3(vec3 v);
     static quat PxQuat_to_quat(PxQuat q);
@@ -50,27 +75,32 @@ class RigidBody {
     void save(Archive& archive) const {
         bool isDynamic = false;
         float mass = 0.0f;
-        if (m_dynamic) {
+        if (PxRigidDynamic* dynamic = get_dynamic()) {
             isDynamic = true;
-            mass = m_dynamic->get()->getMass();
+            mass = dynamic->getMass();
         }
         archive(cereal::make_nvp("isDynamic", isDynamic), cereal::make_nvp("mass", mass));
     }
 
     template <class Archive>
     void load(Archive& archive) {
-        archive(cereal::make_nvp("isDynamic", m_isDynamic), cereal::make_nvp("mass", m_mass));
+        bool isDynamic = false;
+        archive(cereal::make_nvp("isDynamic", isDynamic), cereal::make_nvp("mass", m_mass));
+        m_type = isDynamic ? RigidBodyType::Dynamic : RigidBodyType::Static;
     }
 
    protected:
-    std::shared_ptr<PxPhysics_ptr_wrapper> m_physics;
-    std::shared_ptr<PxScene_ptr_wrapper> m_scene;
-    std::shared_ptr<PxDynamic_ptr_wrapper> m_dynamic;
-    std::shared_ptr<PxStatic_ptr_wrapper> m_static;
-    std::shared_ptr<PxShape_ptr_wrapper> m_shape;
+    // static and kinematic actors never show up as active actors, so a teleport writes the Transform itself
+    void sync_transform();
+
+    PxRigidActor* m_actor = nullptr;
+
+    PxTransform m_previousPose = PxTransform(PxIdentity);
+    PxTransform m_currentPose = PxTransform(PxIdentity);
 
     float m_mass = 0.0f;
-    bool m_isDynamic = false;
+    // set by build_actor, or by load before the actor exists
+    RigidBodyType m_type = RigidBodyType::None;
 };
 
 }  // namespace components
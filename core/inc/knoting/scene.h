@@ -1,20 +1,42 @@
 #pragma once
 
+#include <knoting/string_table.h>
+#include <knoting/transform.h>
 #include <knoting/types.h>
+#include <knoting/uuid_generator.h>
 #include <cereal/cereal.hpp>
 #include <entt/entt.hpp>
+#include <functional>
+#include <map>
 #include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace knot {
 
 class GameObject;
 
+namespace components {
+class Name;
+}
+
 }
 
 namespace knot {
 
+using TagMask = uint64_t;
+
+struct PoolStatistics {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t active = 0;
+    size_t inactive = 0;
+};
+
 class Scene {
    public:
+    Scene();
     ~Scene();
 
     GameObject create_game_object(const std::string& name = "");
@@ -24,6 +46,25 @@ class Scene {
     std::optional<GameObject> get_game_object_from_handle(entt::entity handle);
     entt::registry& get_registry();
 
+    // Reuses an inactive game object from the pool when one is available, otherwise a new one is created and
+    // `construct` is called once to attach its components. Either way the object is placed at `transform`.
+    GameObject acquire_pooled_game_object(const std::string& pool,
+                                          const components::Transform& transform,
+                                          const std::function<void(GameObject)>& construct);
+    // Deactivates the game object in place and hands it back to its pool, its resources stay alive
+    void release_pooled_game_object(GameObject game_object);
+    void clear_pool(const std::string& pool);
+    PoolStatistics get_pool_statistics(const std::string& pool) const;
+
+    void set_game_object_active(GameObject game_object, bool active);
+
+    void rename_game_object(GameObject game_object, const std::string& name);
+    // Active entities whose Tag holds every bit of the mask, or any of them when matchAll is false
+    std::vector<entt::entity> view_with_tags(TagMask mask, bool matchAll = true);
+    std::vector<GameObject> find_game_objects_by_name(const std::string& name);
+    // Substring match over the unique names in the scene, each match expands to its bucket of game objects
+    std::vector<GameObject> search_game_objects(const std::string& query);
+
     template <typename T>
     static std::optional<GameObject> get_game_object_from_component(T& component);
 
@@ -38,9 +79,20 @@ class Scene {
    protected:
     friend class GameObject;
 
+    void on_name_construct(entt::registry& registry, entt::entity handle);
+    void on_name_destroy(entt::registry& registry, entt::entity handle);
+    void link_name(entt::entity handle, components::Name& name);
+    void unlink_name(entt::entity handle, const components::Name& name);
+
+    struct ObjectPool {
+        std::vector<entt::entity> inactive;
+        PoolStatistics statistics;
+    };
+
     entt::registry m_registry;
-    std::map<uuid, GameObject> m_uuidGameObjectMap;
-    std::map<entt::entity, GameObject> m_entityGameObjectMap;
+    std::unordered_map<uuid, GameObject, UUIDHash> m_uuidGameObjectMap;
+    std::map<std::string, ObjectPool> m_pools;
+    std::unordered_map<StringId, std::vector<entt::entity>> m_nameIndex;
 
     inline static std::vector<std::function<void()>> postLoadBuffer;
 
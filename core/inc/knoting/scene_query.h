@@ -0,0 +1,44 @@
+#pragma once
+
+#include <knoting/collision_layer.h>
+#include <knoting/px_variables_wrapper.h>
+#include <knoting/types.h>
+#include <entt/entt.hpp>
+
+namespace knot {
+
+// every query only hits shapes whose layer bit is set in its layerMask, an empty mask hits nothing
+
+struct RaycastQuery {
+    vec3 origin = vec3(0.0f);
+    vec3 unitDir = vec3(0.0f, 0.0f, 1.0f);
+    float maxDistance = 0.0f;
+    CollisionLayerMask layerMask = ALL_COLLISION_LAYERS;
+};
+
+struct SweepQuery {
+    PxGeometryHolder geometry;
+    PxTransform pose = PxTransform(PxIdentity);
+    vec3 unitDir = vec3(0.0f, 0.0f, 1.0f);
+    float maxDistance = 0.0f;
+    CollisionLayerMask layerMask = ALL_COLLISION_LAYERS;
+};
+
+struct OverlapQuery {
+    PxGeometryHolder geometry;
+    PxTransform pose = PxTransform(PxIdentity);
+    CollisionLayerMask layerMask = ALL_COLLISION_LAYERS;
+};
+
+// closest blocking hit of a query, overlaps leave position, normal and distance at their defaults
+struct QueryHit {
+    bool isHit = false;
+    vec3 position = vec3(std::numeric_limits<float>::max());
+    vec3 normal = vec3(std::numeric_limits<float>::max());
+    float distance = std::numeric_limits<float>::max();
+    PxRigidActor* actor = nullptr;
+    PxShape* shape = nullptr;
+    entt::entity entity = entt::null;
+};
+
+}  // namespace knot
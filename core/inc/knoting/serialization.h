@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cereal/cereal.hpp>
+#include <cstring>
+
+namespace knot {
+
+// Scene files are JSON archives read by name, a field a component saves since a later version makes older files
+// throw. Fields appended to a component are read through this and keep their current value when the file has none.
+// Only works on archives with named nodes, and only in the order the fields are saved. Returns whether it was read.
+template <class Archive, class T>
+bool load_optional_nvp(Archive& archive, const char* name, T& value) {
+    const char* next = archive.getNodeName();
+    if (!next || std::strcmp(next, name) != 0) {
+        return false;
+    }
+    archive(cereal::make_nvp(name, value));
+    return true;
+}
+
+}  // namespace knot
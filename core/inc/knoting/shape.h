@@ -1,16 +1,17 @@
 #pragma once
 #include <PxPhysicsAPI.h>
+#include <knoting/collision_cooker.h>
 #include <knoting/components.h>
+#include <knoting/physics_cache.h>
 #include <knoting/px_variables_wrapper.h>
 #include <knoting/rigidbody.h>
 
 namespace knot {
 namespace components {
 
-class Shape {
+class Shape : public OwnedComponent {
    public:
     Shape();
-    ~Shape();
 
     void on_awake();
     void on_destroy();
@@ -19,13 +20,25 @@ class Shape {
     std::weak_ptr<PxMaterial_ptr_wrapper> get_material() { return m_material; }
     std::weak_ptr<PxShape_ptr_wrapper> get_shape() { return m_shape; }
 
-    void set_material(std::shared_ptr<PxMaterial_ptr_wrapper> material) { m_material = material; }
+    // the PxShape is shared through the physics cache and never edited in place, every setter acquires the shape
+    // matching the new parameters and swaps it into the actor of this game object
+    void set_material(std::shared_ptr<PxMaterial_ptr_wrapper> material);
     void set_geometry(const PxGeometry& geometry);
     void set_local_rotation(quat rotation);
+    // see Physics::set_layer_collision for which layers meet
+    void set_layer(CollisionLayer layer);
+    // triggers report overlaps instead of colliding and are skipped by scene queries
+    void set_trigger(bool isTrigger);
+    CollisionLayer get_layer() const { return m_layer; }
+    bool is_trigger() const { return m_isTrigger; }
 
     PxBoxGeometry create_cube_geometry(const vec3& halfsize);
     PxSphereGeometry create_sphere_geometry(const float& radius);
     PxCapsuleGeometry create_capsule_geometry(const float& radius, const float& halfheight);
+    // cooked from the vertices of a Mesh asset, the cooked data is cached on disk
+    PxConvexMeshGeometry create_convex_geometry(const std::string& meshPath, const vec3& scale = vec3(1.0f));
+    // triangle meshes can only be used on static or kinematic actors
+    PxTriangleMeshGeometry create_triangle_mesh_geometry(const std::string& meshPath, const vec3& scale = vec3(1.0f));
 
     std::shared_ptr<PxMaterial_ptr_wrapper> get_PxMaterial_from_pxmaterial();
 
@@ -36,11 +49,20 @@ class Shape {
     void load(Archive& archive);
 
    protected:
-    std::shared_ptr<PxPhysics_ptr_wrapper> m_physics;
+    void acquire_shape();
+
+    // the only references a Shape holds, they keep the shared cache entries alive
     std::shared_ptr<PxShape_ptr_wrapper> m_shape;
     std::shared_ptr<PxMaterial_ptr_wrapper> m_material;
+    PxGeometryHolder m_geometry;
+    bool m_hasGeometry = false;
+    PxTransform m_localPose = PxTransform(PxIdentity);
+    CollisionLayer m_layer = 0;
+    bool m_isTrigger = false;
     vec3 m_shapeSize;
     PxGeometryType::Enum m_shapeType;
+    // source of cooked geometry, empty for primitives
+    std::string m_meshPath;
 };
 }  // namespace components
 }  // namespace knot
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace knot {
+
+using StringId = uint32_t;
+
+// Global, append only table of unique strings. Ids stay valid and strings never move for the lifetime of the
+// process, so components can hold a 4 byte id instead of a std::string and compare names without touching text.
+class StringTable {
+   public:
+    static StringId intern(std::string_view string);
+    static std::optional<StringId> find(std::string_view string);
+    static const std::string& get(StringId id);
+    static size_t size();
+
+   private:
+    inline static std::shared_mutex s_mutex;
+    inline static std::deque<std::string> s_strings;
+    inline static std::unordered_map<std::string_view, StringId> s_ids;
+};
+
+}  // namespace knot
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <knoting/job_system.h>
+#include <entt/entt.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace knot {
+
+class Scene;
+
+}
+
+namespace knot {
+
+using ResourceId = entt::id_type;
+
+// A unit of per frame work over the registry. Systems declare which component types (or any other shared type,
+// e.g. LightData) they read and write, the scheduler derives the execution order from those declarations.
+class System {
+   public:
+    System(const std::string& name, std::function<void(Scene&)> update);
+
+    template <typename... T>
+    System& read() {
+        (m_reads.push_back(entt::type_hash<T>::value()), ...);
+        return *this;
+    }
+
+    template <typename... T>
+    System& write() {
+        (m_writes.push_back(entt::type_hash<T>::value()), ...);
+        return *this;
+    }
+
+    // bgfx and other thread bound APIs only take calls from the thread running the scheduler, such systems never go
+    // to a job worker
+    System& on_main_thread() {
+        m_mainThread = true;
+        return *this;
+    }
+
+    bool conflicts_with(const System& other) const;
+    bool is_main_thread() const { return m_mainThread; }
+
+    const std::string& get_name() const { return m_name; }
+
+   private:
+    friend class SystemScheduler;
+
+    std::string m_name;
+    std::function<void(Scene&)> m_update;
+    std::vector<ResourceId> m_reads;
+    std::vector<ResourceId> m_writes;
+    bool m_mainThread = false;
+};
+
+struct SystemNode {
+    std::string name;
+    // indices into the node list of the systems that have to finish first
+    std::vector<size_t> dependencies;
+    // systems sharing a wave have no conflicts between them and run concurrently
+    size_t wave = 0;
+    double lastDurationMs = 0.0;
+};
+
+// Systems run in waves. A system depends on every previously added system it conflicts with (one writes what the
+// other reads or writes), and lands in the wave after its latest dependency.
+class SystemScheduler {
+   public:
+    explicit SystemScheduler(JobSystem& jobSystem);
+
+    void add_system(const System& system);
+    void remove_system(const std::string& name);
+
+    void run(Scene& scene);
+
+    const std::vector<SystemNode>& get_graph();
+    // also tells whether the last frame took the serial first-frame path instead of the waves
+    void log_graph();
+    bool ran_serially() const { return m_lastRunSerial; }
+
+   private:
+    void build_graph();
+    void run_system(size_t index, Scene& scene);
+
+    JobSystem& m_jobSystem;
+
+    std::vector<System> m_systems;
+    std::vector<SystemNode> m_nodes;
+    std::vector<std::vector<size_t>> m_waves;
+    bool m_dirty = true;
+
+    // the first frame on a scene runs sequentially, systems may lazily create storages and groups in the registry
+    Scene* m_lastScene = nullptr;
+    bool m_lastRunSerial = false;
+};
+
+}  // namespace knot
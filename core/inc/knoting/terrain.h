@@ -0,0 +1,136 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <knoting/collision_cooker.h>
+#include <knoting/job_system.h>
+#include <knoting/mesh.h>
+#include <knoting/physics_cache.h>
+#include <knoting/px_variables_wrapper.h>
+#include <knoting/types.h>
+#include <cereal/cereal.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace knot {
+
+class Scene;
+
+}
+
+namespace knot {
+namespace components {
+
+// heights normalized to [0, 1], row major with x along a row
+struct Heightmap {
+    uint32_t width = 0;
+    uint32_t depth = 0;
+    std::vector<float> heights;
+
+    float sample(int32_t x, int32_t z) const;
+};
+
+enum class TerrainChunkState { Unloaded, Building, Built, Resident, LAST };
+
+struct TerrainChunkLod {
+    std::vector<VertexLayout> vertices;
+    std::vector<uint16_t> indices;
+    bgfx::VertexBufferHandle vbh = BGFX_INVALID_HANDLE;
+    bgfx::IndexBufferHandle ibh = BGFX_INVALID_HANDLE;
+};
+
+struct TerrainChunk {
+    // safety net for terrains removed without on_destroy, releases whatever the chunk still holds
+    ~TerrainChunk();
+
+    uint32_t x = 0;
+    uint32_t z = 0;
+    // local space center, used for the streaming and lod distances
+    vec3 center = vec3(0.0f);
+
+    // written by the build job once the CPU data is ready, everything else happens on the streaming system
+    std::atomic<TerrainChunkState> state = TerrainChunkState::Unloaded;
+    uint32_t lod = 0;
+
+    std::vector<TerrainChunkLod> lods;
+    PxHeightField* heightField = nullptr;
+    std::shared_ptr<PxShape_ptr_wrapper> shape;
+    PxRigidStatic* actor = nullptr;
+};
+
+// Heightmap terrain split into square chunks. Chunks around the camera are built on the job workers (one CPU mesh per
+// lod and a PxHeightField), then uploaded and inserted into the PxScene by the terrain_streaming system. Chunks
+// leaving the radius are released again.
+class Terrain {
+   public:
+    Terrain();
+    Terrain(const std::string& heightmapPath,
+            const vec3& scale = vec3(1.0f, 50.0f, 1.0f),
+            uint32_t chunkSize = 64,
+            float streamRadius = 256.0f);
+
+    void on_awake();
+    void on_load();
+    void on_destroy();
+
+    // terrain_streaming system, streams every terrain of the scene around the first editor camera. Uploads and
+    // releases go through bgfx, so the system is registered on the main thread.
+    static void stream_terrains(Scene& scene);
+    void update_streaming(const vec3& cameraPosition, const vec3& terrainPosition, entt::entity entity);
+
+    // bilinear height in world units at a terrain local position, 0 outside the heightmap
+    float get_height(float x, float z) const;
+
+    const std::string& get_heightmap_path() const { return m_heightmapPath; }
+    vec3 get_scale() const { return m_scale; }
+    uint32_t get_chunk_size() const { return m_chunkSize; }
+    float get_stream_radius() const { return m_streamRadius; }
+    const std::vector<std::shared_ptr<TerrainChunk>>& get_chunks() const { return m_chunks; }
+
+    void set_stream_radius(float radius) { m_streamRadius = radius; }
+    // distance at which each further lod halves the vertex density
+    void set_lod_distance(float distance) { m_lodDistance = distance; }
+
+    template <class Archive>
+    void save(Archive& archive) const {
+        archive(CEREAL_NVP(m_heightmapPath), CEREAL_NVP(m_scale), CEREAL_NVP(m_chunkSize), CEREAL_NVP(m_streamRadius),
+                CEREAL_NVP(m_lodDistance));
+    }
+
+    template <class Archive>
+    void load(Archive& archive) {
+        archive(CEREAL_NVP(m_heightmapPath), CEREAL_NVP(m_scale), CEREAL_NVP(m_chunkSize), CEREAL_NVP(m_streamRadius),
+                CEREAL_NVP(m_lodDistance));
+    }
+
+    static constexpr uint32_t LOD_COUNT = 3;
+    // chunks are indexed with 16 bit indices, (128 + 1)^2 vertices still fit
+    static constexpr uint32_t MAX_CHUNK_SIZE = 128;
+
+   protected:
+    bool load_heightmap();
+    static void build_chunk(TerrainChunk& chunk,
+                            const Heightmap& heightmap,
+                            const vec3& scale,
+                            uint32_t chunkSize,
+                            CollisionCooker& cooker);
+    void upload_chunk(TerrainChunk& chunk, const vec3& terrainPosition, entt::entity entity);
+    void release_chunk(TerrainChunk& chunk);
+
+    std::string m_heightmapPath;
+    vec3 m_scale = vec3(1.0f, 50.0f, 1.0f);
+    uint32_t m_chunkSize = 64;
+    float m_streamRadius = 256.0f;
+    float m_lodDistance = 96.0f;
+
+    std::shared_ptr<const Heightmap> m_heightmap;
+    std::vector<std::shared_ptr<TerrainChunk>> m_chunks;
+    std::vector<JobHandle> m_pendingJobs;
+
+    std::shared_ptr<JobSystem> m_jobSystem;
+    std::shared_ptr<PxMaterial_ptr_wrapper> m_material;
+};
+
+}  // namespace components
+}  // namespace knot
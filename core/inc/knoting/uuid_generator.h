@@ -0,0 +1,38 @@
+#pragma once
+
+#include <knoting/types.h>
+#include <cstddef>
+
+namespace knot {
+
+enum class UUIDMode {
+    // version 4, std::mt19937 backed
+    Random,
+    // version 7, unix milliseconds followed by a per thread counter and random bits
+    TimeOrdered,
+    LAST
+};
+
+// Every thread keeps its own generator state, so game objects can be created from worker threads without locking
+class UUIDGenerator {
+   public:
+    UUIDGenerator(UUIDMode mode = UUIDMode::TimeOrdered);
+
+    uuid generate();
+
+    UUIDMode get_mode() const { return m_mode; }
+    void set_mode(UUIDMode mode) { m_mode = mode; }
+
+   protected:
+    uuid generate_random();
+    uuid generate_time_ordered();
+
+    UUIDMode m_mode;
+};
+
+// Hashes the raw 16 bytes, the std::hash provided by stduuid goes through to_string
+struct UUIDHash {
+    size_t operator()(const uuid& id) const noexcept;
+};
+
+}  // namespace knot
@@ -0,0 +1,258 @@
+#include <characterkinematic/PxBoxController.h>
+#include <characterkinematic/PxCapsuleController.h>
+#include <knoting/character_controller.h>
+#include <knoting/engine.h>
+#include <knoting/physics.h>
+#include <knoting/scene.h>
+
+#include <cmath>
+#include <utility>
+
+namespace knot {
+namespace components {
+
+// moves shorter than this are dropped by the CCT
+constexpr float MIN_MOVE_DISTANCE = 0.001f;
+
+CharacterController::CharacterController() {}
+
+CharacterController::CharacterController(CharacterShape shape,
+                                         float radius,
+                                         float height,
+                                         float stepOffset,
+                                         float slopeLimitDegrees)
+    : m_shape(shape),
+      m_radius(radius),
+      m_height(height),
+      m_stepOffset(stepOffset),
+      m_slopeLimitDegrees(slopeLimitDegrees) {}
+
+CharacterController::CharacterController(CharacterController&& other) noexcept {
+    *this = std::move(other);
+}
+
+CharacterController& CharacterController::operator=(CharacterController&& other) noexcept {
+    if (this != &other) {
+        release_controller();
+        OwnedComponent::operator=(other);
+        m_controller = std::exchange(other.m_controller, nullptr);
+        m_material = std::move(other.m_material);
+        m_shape = other.m_shape;
+        m_radius = other.m_radius;
+        m_height = other.m_height;
+        m_stepOffset = other.m_stepOffset;
+        m_slopeLimitDegrees = other.m_slopeLimitDegrees;
+        m_layer = other.m_layer;
+        m_moveVelocity = other.m_moveVelocity;
+        m_verticalSpeed = other.m_verticalSpeed;
+        m_lastDisplacement = other.m_lastDisplacement;
+        m_previousFoot = other.m_previousFoot;
+        m_currentFoot = other.m_currentFoot;
+        m_collisionFlags = other.m_collisionFlags;
+    }
+    return *this;
+}
+
+void CharacterController::on_awake() {
+    Transform* transform = get_sibling<Transform>();
+    create_controller(transform ? transform->get_position() : vec3(0.0f));
+}
+
+void CharacterController::on_load() {
+    on_awake();
+}
+
+void CharacterController::on_destroy() {
+    release_controller();
+}
+
+void CharacterController::jump(float speed) {
+    if (is_grounded()) {
+        m_verticalSpeed = speed;
+    }
+}
+
+void CharacterController::teleport(const vec3& footPosition) {
+    restore_state(footPosition, 0.0f);
+}
+
+void CharacterController::restore_state(const vec3& footPosition, float verticalSpeed) {
+    Physics* physics = Physics::get_instance();
+    if (!m_controller || !physics) {
+        return;
+    }
+    physics->end_simulation();
+    m_controller->setFootPosition(PxExtendedVec3(footPosition.x, footPosition.y, footPosition.z));
+    m_verticalSpeed = verticalSpeed;
+    reset_foot_history();
+
+    if (Transform* transform = get_sibling<Transform>()) {
+        transform->set_position(m_currentFoot);
+    }
+}
+
+void CharacterController::set_layer(CollisionLayer layer) {
+    m_layer = layer;
+    apply_layer();
+}
+
+void CharacterController::set_simulation_enabled(bool enabled) {
+    Physics* physics = Physics::get_instance();
+    if (!m_controller || !physics) {
+        return;
+    }
+    PxRigidDynamic* actor = m_controller->getActor();
+    PxShape* shape = nullptr;
+    actor->getShapes(&shape, 1);
+
+    // simulation shapes are not allowed on an actor that does not simulate, so the flags go in opposite order
+    physics->end_simulation();
+    if (!enabled) {
+        if (shape) {
+            shape->setFlag(PxShapeFlag::eSCENE_QUERY_SHAPE, false);
+            shape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, false);
+        }
+        actor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, true);
+        return;
+    }
+    actor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, false);
+    if (shape) {
+        shape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, true);
+        shape->setFlag(PxShapeFlag::eSCENE_QUERY_SHAPE, true);
+    }
+}
+
+vec3 CharacterController::get_foot_position() const {
+    if (!m_controller) {
+        return vec3(0.0f);
+    }
+    const PxExtendedVec3 foot = m_controller->getFootPosition();
+    return vec3(static_cast<float>(foot.x), static_cast<float>(foot.y), static_cast<float>(foot.z));
+}
+
+vec3 CharacterController::get_interpolated_foot_position(float alpha) const {
+    return glm::mix(m_previousFoot, m_currentFoot, alpha);
+}
+
+void CharacterController::move(float dt,
+                               const PxVec3& gravity,
+                               const CollisionMatrix& matrix,
+                               PxQueryFilterCallback* filterCallback,
+                               PxControllerFilterCallback* controllerFilterCallback,
+                               const PxObstacleContext* obstacles) {
+    if (!m_controller) {
+        return;
+    }
+
+    // grounded characters keep a small downward push so they stay on slopes and stairs going down
+    if (is_grounded() && m_verticalSpeed <= 0.0f) {
+        m_verticalSpeed = 0.0f;
+    }
+    m_verticalSpeed += gravity.y * dt;
+
+    const PxVec3 displacement(m_moveVelocity.x * dt, (m_moveVelocity.y + m_verticalSpeed) * dt, m_moveVelocity.z * dt);
+
+    // the built in query filter ands this against the layer bit every shape carries in its query word0
+    PxFilterData filterData;
+    filterData.word0 = matrix.masks[m_layer % MAX_COLLISION_LAYERS];
+    PxControllerFilters filters(&filterData, filterCallback, controllerFilterCallback);
+    if (filterData.word0 == 0) {
+        // the built in filter is skipped for all zero filter data, a layer that collides with nothing queries nothing
+        filters.mFilterFlags = PxQueryFlags();
+    }
+
+    const PxExtendedVec3 before = m_controller->getFootPosition();
+    m_collisionFlags = m_controller->move(displacement, MIN_MOVE_DISTANCE, dt, filters, obstacles);
+    const PxExtendedVec3 after = m_controller->getFootPosition();
+
+    m_lastDisplacement = vec3(static_cast<float>(after.x - before.x), static_cast<float>(after.y - before.y),
+                              static_cast<float>(after.z - before.z));
+    m_previousFoot = m_currentFoot;
+    m_currentFoot = get_foot_position();
+    if (hit_ceiling() && m_verticalSpeed > 0.0f) {
+        m_verticalSpeed = 0.0f;
+    }
+}
+
+void CharacterController::create_controller(const vec3& footPosition) {
+    release_controller();
+
+    Physics* physics = Physics::get_instance();
+    PxControllerManager* manager = Physics::get_controller_manager();
+    if (!physics || !manager) {
+        return;
+    }
+    m_material = Physics::get_physics_cache()->acquire_material(0.5f, 0.5f, 0.0f);
+
+    const PxExtendedVec3 foot(footPosition.x, footPosition.y, footPosition.z);
+    const float slopeLimit = std::cos(glm::radians(m_slopeLimitDegrees));
+
+    // the CCT adds its kinematic actor to the scene, which has to wait for a running step
+    physics->end_simulation();
+    if (m_shape == CharacterShape::Box) {
+        PxBoxControllerDesc desc;
+        desc.halfSideExtent = m_radius;
+        desc.halfForwardExtent = m_radius;
+        desc.halfHeight = m_height * 0.5f;
+        desc.stepOffset = m_stepOffset;
+        desc.slopeLimit = slopeLimit;
+        desc.material = m_material->get();
+        m_controller = manager->createController(desc);
+        if (m_controller) {
+            m_controller->setFootPosition(foot);
+        }
+    } else {
+        PxCapsuleControllerDesc desc;
+        desc.radius = m_radius;
+        desc.height = m_height;
+        desc.stepOffset = m_stepOffset;
+        desc.slopeLimit = slopeLimit;
+        desc.material = m_material->get();
+        m_controller = manager->createController(desc);
+        if (m_controller) {
+            m_controller->setFootPosition(foot);
+        }
+    }
+
+    if (!m_controller) {
+        log::error("physics could not create a character controller");
+        return;
+    }
+    Physics::set_actor_entity(*m_controller->getActor(), m_entity);
+    reset_foot_history();
+    apply_layer();
+}
+
+void CharacterController::release_controller() {
+    // the manager releases every controller it still owns when physics shuts down first
+    if (m_controller && Physics::get_controller_manager()) {
+        Physics* physics = Physics::get_instance();
+        physics->end_simulation();
+        physics->note_removed_actor(*m_controller->getActor());
+        m_controller->release();
+    }
+    m_controller = nullptr;
+    m_collisionFlags = PxControllerCollisionFlags();
+}
+
+void CharacterController::apply_layer() {
+    Physics* physics = Physics::get_instance();
+    if (!m_controller || !physics) {
+        return;
+    }
+    PxShape* shape = nullptr;
+    if (m_controller->getActor()->getShapes(&shape, 1) == 0) {
+        return;
+    }
+    physics->end_simulation();
+    shape->setSimulationFilterData(make_simulation_filter_data(m_layer));
+    shape->setQueryFilterData(make_query_filter_data(m_layer));
+}
+
+void CharacterController::reset_foot_history() {
+    m_currentFoot = get_foot_position();
+    m_previousFoot = m_currentFoot;
+}
+
+}  // namespace components
+}  // namespace knot
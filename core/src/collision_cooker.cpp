@@ -0,0 +1,193 @@
+#include <knoting/asset_manager.h>
+#include <knoting/collision_cooker.h>
+#include <knoting/log.h>
+#include <knoting/mesh.h>
+
+#include <spdlog/fmt/fmt.h>
+#include <fstream>
+
+namespace knot {
+
+// bump when cooking parameters change so stale cooked files are not picked up
+constexpr uint32_t COOKED_FORMAT_VERSION = 1;
+
+CollisionCooker::CollisionCooker(PxFoundation& foundation, PxPhysics& physics) : m_physics(physics) {
+    PxCookingParams params(physics.getTolerancesScale());
+    // obj meshes are loaded unindexed, welding restores the shared vertices before cooking
+    params.meshPreprocessParams |= PxMeshPreprocessingFlag::eWELD_VERTICES;
+    params.meshWeldTolerance = 0.001f;
+    m_cooking = PxCreateCooking(PX_PHYSICS_VERSION, foundation, params);
+    if (!m_cooking) {
+        log::error("collision cooker failed to create PxCooking");
+    }
+}
+
+CollisionCooker::~CollisionCooker() {
+    for (auto& [hash, mesh] : m_meshes) {
+        mesh->release();
+    }
+    if (m_cooking) {
+        m_cooking->release();
+    }
+}
+
+PxConvexMesh* CollisionCooker::acquire_convex_mesh(const std::string& meshPath) {
+    PxBase* mesh = acquire(CollisionMeshType::Convex, meshPath);
+    return mesh ? mesh->is<PxConvexMesh>() : nullptr;
+}
+
+PxTriangleMesh* CollisionCooker::acquire_triangle_mesh(const std::string& meshPath) {
+    PxBase* mesh = acquire(CollisionMeshType::Triangle, meshPath);
+    return mesh ? mesh->is<PxTriangleMesh>() : nullptr;
+}
+
+PxHeightField* CollisionCooker::create_height_field(const PxHeightFieldDesc& desc) {
+    if (!m_cooking) {
+        return nullptr;
+    }
+    return m_cooking->createHeightField(desc, m_physics.getPhysicsInsertionCallback());
+}
+
+std::filesystem::path CollisionCooker::get_cooked_path() {
+    return AssetManager::get_resources_path().append("cooked/");
+}
+
+PxBase* CollisionCooker::acquire(CollisionMeshType type, const std::string& meshPath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto& pathHashes = m_pathHashes[static_cast<size_t>(type)];
+    auto pathIt = pathHashes.find(meshPath);
+    if (pathIt != pathHashes.end()) {
+        return m_meshes[pathIt->second];
+    }
+
+    SourceData source;
+    if (!load_source(meshPath, source)) {
+        return nullptr;
+    }
+    uint64_t hash = hash_source(type, source);
+
+    auto meshIt = m_meshes.find(hash);
+    if (meshIt != m_meshes.end()) {
+        pathHashes[meshPath] = hash;
+        return meshIt->second;
+    }
+
+    const char* extension = type == CollisionMeshType::Convex ? ".convex" : ".triangles";
+    std::filesystem::path cookedPath = get_cooked_path().append(fmt::format("{:016x}{}", hash, extension));
+
+    std::vector<uint8_t> cooked;
+    if (!read_cooked(cookedPath, cooked)) {
+        PxDefaultMemoryOutputStream output;
+        if (!cook(type, source, output)) {
+            log::error("collision cooker failed to cook {}", meshPath);
+            return nullptr;
+        }
+        write_cooked(cookedPath, output);
+        cooked.assign(output.getData(), output.getData() + output.getSize());
+        log::debug("collision cooker cooked {} into {}", meshPath, cookedPath.string());
+    }
+
+    PxDefaultMemoryInputData input(cooked.data(), static_cast<PxU32>(cooked.size()));
+    PxBase* mesh = nullptr;
+    if (type == CollisionMeshType::Convex) {
+        mesh = m_physics.createConvexMesh(input);
+    } else {
+        mesh = m_physics.createTriangleMesh(input);
+    }
+    if (!mesh) {
+        log::error("collision cooker could not create a mesh from {}", cookedPath.string());
+        return nullptr;
+    }
+
+    m_meshes[hash] = mesh;
+    pathHashes[meshPath] = hash;
+    return mesh;
+}
+
+bool CollisionCooker::load_source(const std::string& meshPath, SourceData& source) {
+    auto mesh = AssetManager::load_asset<components::Mesh>(meshPath).lock();
+    if (!mesh || mesh->get_asset_state() != AssetState::Finished) {
+        log::warn("collision cooker could not load mesh {}", meshPath);
+        return false;
+    }
+
+    for (const vec3& position : mesh->get_positions()) {
+        source.positions.emplace_back(position.x, position.y, position.z);
+    }
+    source.indices = mesh->get_indices();
+    if (source.indices.empty()) {
+        // unindexed triangle list
+        source.indices.resize(source.positions.size());
+        for (uint32_t i = 0; i < source.indices.size(); ++i) {
+            source.indices[i] = i;
+        }
+    }
+    return !source.positions.empty();
+}
+
+bool CollisionCooker::cook(CollisionMeshType type, const SourceData& source, PxDefaultMemoryOutputStream& output) {
+    if (!m_cooking) {
+        return false;
+    }
+
+    if (type == CollisionMeshType::Convex) {
+        PxConvexMeshDesc desc;
+        desc.points.count = static_cast<PxU32>(source.positions.size());
+        desc.points.stride = sizeof(PxVec3);
+        desc.points.data = source.positions.data();
+        desc.flags = PxConvexFlag::eCOMPUTE_CONVEX;
+        return m_cooking->cookConvexMesh(desc, output);
+    }
+
+    PxTriangleMeshDesc desc;
+    desc.points.count = static_cast<PxU32>(source.positions.size());
+    desc.points.stride = sizeof(PxVec3);
+    desc.points.data = source.positions.data();
+    desc.triangles.count = static_cast<PxU32>(source.indices.size() / 3);
+    desc.triangles.stride = 3 * sizeof(uint32_t);
+    desc.triangles.data = source.indices.data();
+    return m_cooking->cookTriangleMesh(desc, output);
+}
+
+bool CollisionCooker::read_cooked(const std::filesystem::path& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    data.resize(static_cast<size_t>(size));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), size));
+}
+
+void CollisionCooker::write_cooked(const std::filesystem::path& path, const PxDefaultMemoryOutputStream& data) {
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        log::warn("collision cooker could not write {}", path.string());
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(data.getData()), data.getSize());
+}
+
+uint64_t CollisionCooker::hash_source(CollisionMeshType type, const SourceData& source) {
+    // FNV-1a over the cooking inputs
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    uint32_t header[] = {COOKED_FORMAT_VERSION, static_cast<uint32_t>(type), PX_PHYSICS_VERSION};
+    mix(header, sizeof(header));
+    mix(source.positions.data(), source.positions.size() * sizeof(PxVec3));
+    mix(source.indices.data(), source.indices.size() * sizeof(uint32_t));
+    return hash;
+}
+
+}  // namespace knot
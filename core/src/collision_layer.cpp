@@ -0,0 +1,59 @@
+#include <knoting/collision_layer.h>
+
+namespace knot {
+
+void CollisionMatrix::set_collision(CollisionLayer a, CollisionLayer b, bool collide) {
+    a %= MAX_COLLISION_LAYERS;
+    b %= MAX_COLLISION_LAYERS;
+    if (collide) {
+        masks[a] |= 1u << b;
+        masks[b] |= 1u << a;
+    } else {
+        masks[a] &= ~(1u << b);
+        masks[b] &= ~(1u << a);
+    }
+}
+
+PxFilterData make_simulation_filter_data(CollisionLayer layer) {
+    return PxFilterData(layer % MAX_COLLISION_LAYERS, 0, 0, 0);
+}
+
+PxFilterData make_query_filter_data(CollisionLayer layer) {
+    return PxFilterData(1u << (layer % MAX_COLLISION_LAYERS), 0, 0, 0);
+}
+
+PxFilterFlags collision_layer_filter_shader(PxFilterObjectAttributes attributes0,
+                                            PxFilterData filterData0,
+                                            PxFilterObjectAttributes attributes1,
+                                            PxFilterData filterData1,
+                                            PxPairFlags& pairFlags,
+                                            const void* constantBlock,
+                                            PxU32 constantBlockSize) {
+    const CollisionMatrix* matrix =
+        constantBlockSize == sizeof(CollisionMatrix) ? static_cast<const CollisionMatrix*>(constantBlock) : nullptr;
+    if (matrix && !matrix->can_collide(filterData0.word0, filterData1.word0)) {
+        return PxFilterFlag::eKILL;
+    }
+
+    const bool isTrigger0 = PxFilterObjectIsTrigger(attributes0);
+    const bool isTrigger1 = PxFilterObjectIsTrigger(attributes1);
+    if (isTrigger0 || isTrigger1) {
+        // static geometry can never enter or leave a trigger
+        const bool isStatic0 = PxGetFilterObjectType(attributes0) == PxFilterObjectType::eRIGID_STATIC;
+        const bool isStatic1 = PxGetFilterObjectType(attributes1) == PxFilterObjectType::eRIGID_STATIC;
+        if ((isTrigger0 && isStatic1) || (isTrigger1 && isStatic0)) {
+            return PxFilterFlag::eKILL;
+        }
+        pairFlags = PxPairFlag::eTRIGGER_DEFAULT;
+        return PxFilterFlag::eDEFAULT;
+    }
+
+    pairFlags = PxPairFlag::eCONTACT_DEFAULT;
+    if (matrix && matrix->is_reported(filterData0.word0, filterData1.word0)) {
+        pairFlags |=
+            PxPairFlag::eNOTIFY_TOUCH_FOUND | PxPairFlag::eNOTIFY_TOUCH_LOST | PxPairFlag::eNOTIFY_CONTACT_POINTS;
+    }
+    return PxFilterFlag::eDEFAULT;
+}
+
+}  // namespace knot
@@ -1,13 +1,18 @@
 #include <bx/math.h>
+#include <knoting/components.h>
 #include <knoting/engine.h>
+#include <knoting/scene.h>
+#include <knoting/spot_light.h>
 
 namespace knot {
 
-Engine::Engine() {
+Engine::Engine(const EngineSettings& settings) : m_settings(settings) {
+    m_jobSystem = std::make_shared<knot::JobSystem>(m_settings.jobWorkerCount);
     m_windowModule = std::make_shared<knot::Window>(m_windowWidth, m_windowHeight, m_windowTitle, *this);
     m_forwardRenderModule = std::make_shared<knot::ForwardRenderer>(*this);
     m_physicsModule = std::make_shared<knot::Physics>(*this);
     m_assetManager = std::make_shared<knot::AssetManager>();
+    m_systemScheduler = std::make_shared<knot::SystemScheduler>(*m_jobSystem);
 
     // order dependent
     m_engineModules.emplace_back(m_windowModule);
@@ -18,6 +23,7 @@ Engine::Engine() {
     for (auto& module : m_engineModules) {
         module->on_awake();
     }
+    add_core_systems();
     log::debug("init engine");
 }
 
@@ -27,6 +33,11 @@ void Engine::update_modules() {
         module->on_fixed_update();
     }
 
+    auto sceneOpt = Scene::get_active_scene();
+    if (sceneOpt) {
+        m_systemScheduler->run(sceneOpt.value());
+    }
+
     // TODO move into functions when functionality exists
 
     // CORE SYSTEM ORDER
@@ -80,7 +91,35 @@ std::optional<std::reference_wrapper<Engine>> Engine::get_active_engine() {
 void Engine::set_active_engine(std::optional<std::reference_wrapper<Engine>> engine) {
     s_activeEngine = std::ref(engine);
 }
+
+void Engine::add_core_systems() {
+    using namespace components;
+
+    // order dependent, a system runs after every earlier system it conflicts with
+    // the lambdas go through the members so reset_physics_module does not leave them dangling
+    m_systemScheduler->add_system(
+        System("physics_transform_sync", [this](Scene& scene) { m_physicsModule->update_info_to_transform(scene); })
+            .read<RigidBody>()
+            .write<Transform>());
+    m_systemScheduler->add_system(
+        System("raycast_queries", [this](Scene& scene) { m_physicsModule->update_raycasts(scene); })
+            .read<RigidBody, PxScene>()
+            .write<Raycast>());
+    // creates and destroys the chunk vertex and index buffers
+    m_systemScheduler->add_system(System("terrain_streaming", &Terrain::stream_terrains)
+                                      .read<Transform, EditorCamera>()
+                                      .write<Terrain, PxScene>()
+                                      .on_main_thread());
+    m_systemScheduler->add_system(
+        System("light_packing", [this](Scene& scene) { m_forwardRenderModule->pack_lights(scene); })
+            .read<Transform, SpotLight>()
+            .write<LightData>());
+
+    m_systemScheduler->log_graph();
+}
+
 void Engine::reset_physics_module() {
+    m_physicsModule->on_destroy();
     m_physicsModule.reset();
     m_physicsModule = std::make_shared<knot::Physics>(*this);
     m_physicsModule->on_awake();
@@ -2,6 +2,7 @@
 #include <knoting/forward_renderer.h>
 #include <knoting/instance_mesh.h>
 #include <knoting/mesh.h>
+#include <knoting/physics.h>
 #include <knoting/spot_light.h>
 #include <knoting/texture.h>
 
@@ -9,6 +10,7 @@
 #include <knoting/engine.h>
 #include <knoting/scene.h>
 #include <stb_image.h>
+#include <cstring>
 #include <fstream>
 #include <string_view>
 #include <vector>
@@ -33,6 +35,8 @@ void ForwardRenderer::on_render() {
 
     //=CAMERA===========================
     auto cameras = registry.view<Transform, EditorCamera, Name>();
+    glm::mat4 cameraView = glm::mat4(1.0f);
+    glm::mat4 cameraProj = glm::mat4(1.0f);
 
     for (auto& cam : cameras) {
         auto goOpt = scene.get_game_object_from_handle(cam);
@@ -61,44 +65,19 @@ void ForwardRenderer::on_render() {
             glm::mat4 proj = glm::perspective(fovY, aspectRatio, zNear, zFar);
 
             bgfx::setViewTransform(0, &view[0][0], &proj[0][0]);
+            cameraView = view;
+            cameraProj = proj;
         }
     }
 
     //=SPOT LIGHTS======================
-    // TODO consider writing a system to skip this system if light data has not changed between frames
-    // TODO consider writing 2 systems 1 for static lights where this data is set 'on_awake'
-    auto lights = registry.view<Transform, SpotLight>();
-    m_lightData.set_spotlight_count(lights.size_hint());
-    m_lightData.clear_spotlight();
-    for (auto& e : lights) {
-        auto goOpt = scene.get_game_object_from_handle(e);
-        if (!goOpt) {
-            continue;
-        }
-        GameObject go = goOpt.value();
-        Transform& transform = go.get_component<Transform>();
-        SpotLight& spotLight = go.get_component<SpotLight>();
-
-        // Packed uniform data
-        m_lightData.push_spotlight_pos_outer_rad(vec4(transform.get_position(), spotLight.get_outer_radius()));
-        m_lightData.push_spotlight_color_inner_rad(vec4(spotLight.get_color(), spotLight.get_inner_radius()));
-    }
+    // packed by the light_packing system, see ForwardRenderer::pack_lights
 
     //=PBR PIPELINE===========================
 
-    auto entities = registry.view<Transform, InstanceMesh, Material, Name>();
-    for (auto& e : entities) {
-        auto goOpt = scene.get_game_object_from_handle(e);
-        if (!goOpt) {
-            continue;
-        }
-
-        GameObject go = goOpt.value();
-        Transform& transform = go.get_component<Transform>();
-        InstanceMesh& mesh = go.get_component<InstanceMesh>();
-        Material& material = go.get_component<Material>();
-        Name& name = go.get_component<Name>();
-
+    // owning group, InstanceMesh and Material are kept packed in the same order so this walks them linearly
+    auto entities = registry.group<InstanceMesh, Material>(entt::get<Transform>, entt::exclude<Inactive>);
+    for (auto [e, mesh, material, transform] : entities.each()) {
         bgfx::setTransform(value_ptr(transform.get_model_matrix()));
 
         // Set vertex and index buffer.
@@ -119,6 +98,100 @@ void ForwardRenderer::on_render() {
 
         bgfx::submit(0, material.get_program());
     }
+
+    //=TERRAIN================================
+    // chunks are placed in terrain local space, only the terrain position is applied to match the collision
+    auto terrains = registry.view<Terrain, Material, Transform>(entt::exclude<Inactive>);
+    for (auto [e, terrain, material, transform] : terrains.each()) {
+        const glm::mat4 model = glm::translate(glm::mat4(1.0f), transform.get_position());
+
+        for (auto& chunk : terrain.get_chunks()) {
+            if (chunk->state.load(std::memory_order_acquire) != TerrainChunkState::Resident) {
+                continue;
+            }
+            const TerrainChunkLod& chunkLod = chunk->lods[chunk->lod];
+
+            bgfx::setTransform(value_ptr(model));
+            bgfx::setVertexBuffer(0, chunkLod.vbh);
+            bgfx::setIndexBuffer(chunkLod.ibh);
+
+            m_lightData.set_spotlight_uniforms();
+            material.set_uniforms();
+
+            bgfx::setState(0 | BGFX_STATE_MSAA | BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_WRITE_Z |
+                           BGFX_STATE_DEPTH_TEST_LESS);
+
+            bgfx::submit(0, material.get_program());
+        }
+    }
+
+    //=PHYSICS DEBUG==========================
+    render_physics_debug(cameraView, cameraProj);
+}
+
+void ForwardRenderer::render_physics_debug(const glm::mat4& view, const glm::mat4& proj) {
+    auto physics = m_engine.get_physics_module().lock();
+    if (!physics || !physics->is_debug_visualization_enabled()) {
+        return;
+    }
+
+    if (!m_debugShaderLoaded) {
+        PhysicsDebugVertex::init();
+        m_debugShaderLoaded = m_debugShader.load_shader("debug", "vs_debug.bin", "fs_debug.bin");
+        if (!m_debugShaderLoaded) {
+            return;
+        }
+    }
+
+    bgfx::setViewRect(PHYSICS_DEBUG_VIEW, 0, 0, bgfx::BackbufferRatio::Equal);
+    bgfx::setViewTransform(PHYSICS_DEBUG_VIEW, &view[0][0], &proj[0][0]);
+    bgfx::touch(PHYSICS_DEBUG_VIEW);
+
+    submit_debug_geometry(physics->get_debug_lines(), BGFX_STATE_PT_LINES);
+    submit_debug_geometry(physics->get_debug_triangles(), 0);
+}
+
+void ForwardRenderer::submit_debug_geometry(const std::vector<PhysicsDebugVertex>& vertices, uint64_t primitiveState) {
+    if (vertices.empty()) {
+        return;
+    }
+
+    // the transient pool is shared with the rest of the frame, whatever does not fit is dropped
+    uint32_t count = bgfx::getAvailTransientVertexBuffer(static_cast<uint32_t>(vertices.size()),
+                                                         PhysicsDebugVertex::s_layout);
+    const uint32_t primitiveSize = primitiveState == BGFX_STATE_PT_LINES ? 2 : 3;
+    count -= count % primitiveSize;
+    if (count < vertices.size()) {
+        log::warn("physics debug geometry truncated to {} of {} vertices", count, vertices.size());
+    }
+    if (count == 0) {
+        return;
+    }
+
+    bgfx::TransientVertexBuffer buffer;
+    bgfx::allocTransientVertexBuffer(&buffer, count, PhysicsDebugVertex::s_layout);
+    std::memcpy(buffer.data, vertices.data(), count * sizeof(PhysicsDebugVertex));
+
+    bgfx::setVertexBuffer(0, &buffer);
+    bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_DEPTH_TEST_LEQUAL | BGFX_STATE_MSAA |
+                   primitiveState);
+    bgfx::submit(PHYSICS_DEBUG_VIEW, m_debugShader.get_program());
+}
+
+void ForwardRenderer::pack_lights(Scene& scene) {
+    using namespace components;
+    entt::registry& registry = scene.get_registry();
+
+    // TODO consider writing a system to skip this system if light data has not changed between frames
+    // TODO consider writing 2 systems 1 for static lights where this data is set 'on_awake'
+    auto lights = registry.view<Transform, SpotLight>(entt::exclude<Inactive>);
+    m_lightData.clear_spotlight();
+    for (auto [e, transform, spotLight] : lights.each()) {
+        // Packed uniform data
+        m_lightData.push_spotlight_pos_outer_rad(vec4(transform.get_position(), spotLight.get_outer_radius()));
+        m_lightData.push_spotlight_color_inner_rad(vec4(spotLight.get_color(), spotLight.get_inner_radius()));
+    }
+    m_lightData.set_spotlight_count((uint16_t)m_lightData.m_spotlightData.m_spotlightsPositionOuterRadius.size());
 }
 
 void ForwardRenderer::on_post_render() {}
@@ -131,7 +204,12 @@ void ForwardRenderer::on_update(double m_delta_time) {
 
 void ForwardRenderer::on_late_update() {}
 
-void ForwardRenderer::on_destroy() {}
+void ForwardRenderer::on_destroy() {
+    if (m_debugShaderLoaded) {
+        bgfx::destroy(m_debugShader.get_program());
+        m_debugShaderLoaded = false;
+    }
+}
 
 void ForwardRenderer::recreate_framebuffer(uint16_t width, uint16_t height, uint16_t id) {
     bgfx::reset((uint32_t)width, (uint32_t)height, BGFX_RESET_VSYNC);
@@ -37,45 +37,73 @@ void Hierarchy::remove_child(GameObject child) {
     m_children.erase(std::remove(m_children.begin(), m_children.end(), child.get_id()), m_children.end());
 }
 
-Tag::Tag(const std::string& tag) : m_id(0) {
+Name::Name(const std::string& name) : m_id(StringTable::intern(name)) {}
+Name::Name() : m_id(StringTable::intern(DEFAULT_NAME)) {}
+
+const std::string& Name::get_name() const {
+    return StringTable::get(m_id);
+}
+
+Tag::Tag(const std::string& tag) : m_mask(0) {
     if (tag.empty()) {
         return;
     }
 
-    auto it = s_tags.find(tag);
-    if (it == s_tags.end()) {
+    m_mask = get_tag_mask(tag);
+    if (m_mask == 0) {
         log::debug("Tag '{}' not found", tag);
-        return;
     }
+}
+
+Tag::Tag(TagMask mask) : m_mask(mask) {}
 
-    m_id = it->second;
+std::vector<std::string> Tag::get_tags() const {
+    std::vector<std::string> tags;
+    for (uint8_t bit = 0; bit < s_nextBit; ++bit) {
+        if ((m_mask & (TagMask(1) << bit)) && !s_names[bit].empty()) {
+            tags.push_back(s_names[bit]);
+        }
+    }
+    return tags;
 }
 
-uint16_t Tag::get_id() const {
-    return m_id;
+bool Tag::has_tag(const std::string& tag) const {
+    TagMask mask = get_tag_mask(tag);
+    return mask != 0 && has_all(mask);
 }
 
-std::string Tag::get_tag() const {
-    auto it = s_ids.find(m_id);
-    if (it == s_ids.end()) {
-        return "";
+void Tag::add_tag(const std::string& tag) {
+    TagMask mask = get_tag_mask(tag);
+    if (mask == 0) {
+        log::debug("Tag '{}' not found", tag);
+        return;
     }
-    return it->second;
+    m_mask |= mask;
+}
+
+void Tag::remove_tag(const std::string& tag) {
+    m_mask &= ~get_tag_mask(tag);
 }
 
-void Tag::register_tag(const std::string& tag) {
+TagMask Tag::register_tag(const std::string& tag) {
     if (tag.empty()) {
-        return;
+        return 0;
     }
 
     auto it = s_tags.find(tag);
     if (it != s_tags.end()) {
-        return;
+        return TagMask(1) << it->second;
+    }
+
+    if (s_nextBit >= MAX_TAGS) {
+        log::error("Can not register tag '{}', all {} tags are in use", tag, MAX_TAGS);
+        return 0;
     }
 
-    uint16_t id = s_next_id++;
-    s_tags.insert({tag, id});
-    s_ids.insert({id, tag});
+    uint8_t bit = s_nextBit++;
+    s_tags.insert({tag, bit});
+    s_names[bit] = tag;
+    return TagMask(1) << bit;
 }
 
 void Tag::unregister_tag(const std::string& tag) {
@@ -88,8 +116,16 @@ void Tag::unregister_tag(const std::string& tag) {
         return;
     }
 
-    s_tags.erase(it->first);
-    s_ids.erase(it->second);
+    s_names[it->second].clear();
+    s_tags.erase(it);
+}
+
+TagMask Tag::get_tag_mask(const std::string& tag) {
+    auto it = s_tags.find(tag);
+    if (it == s_tags.end()) {
+        return 0;
+    }
+    return TagMask(1) << it->second;
 }
 
 std::vector<std::string> Tag::get_registered_tags() {
@@ -102,22 +138,14 @@ std::vector<std::string> Tag::get_registered_tags() {
 
 }  // namespace components
 
-UUIDGenerator::UUIDGenerator() {
-    std::random_device randomDevice;
-    std::array<int, std::mt19937::state_size> seedData;
-    std::generate(std::begin(seedData), std::end(seedData), std::ref(randomDevice));
-    std::seed_seq seedSequences(std::begin(seedData), std::end(seedData));
-
-    m_randomGenerator = std::mt19937(seedSequences);
-    m_uuidGenerator = std::make_unique<uuids::uuid_random_generator>(m_randomGenerator);
-}
-
-uuid UUIDGenerator::generate() {
-    return (*m_uuidGenerator)();
+GameObject::GameObject(entt::entity handle, Scene& scene) : m_handle(handle), m_scene(scene) {
+    if (!has_component<uuid>()) {
+        add_component<uuid>(s_uuidGenerator.generate());
+    }
 }
 
-GameObject::GameObject(entt::entity handle, Scene& scene) : m_handle(handle), m_scene(scene) {
-    this->try_add_component<uuid>(s_uuidGenerator.generate());
+void GameObject::set_name(const std::string& name) {
+    m_scene.get().rename_game_object(*this, name);
 }
 
 const uuid GameObject::get_id() const {
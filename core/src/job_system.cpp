@@ -0,0 +1,177 @@
+#include <knoting/job_system.h>
+#include <knoting/log.h>
+
+#include <algorithm>
+
+namespace knot {
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    if (workerCount == 0) {
+        workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_queues.emplace_back(std::make_unique<WorkQueue>());
+    }
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&JobSystem::worker_loop, this, i);
+    }
+    log::debug("job system started {} workers", workerCount);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running = false;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+JobHandle JobSystem::submit(std::function<void()> job) {
+    JobHandle counter = std::make_shared<JobCounter>();
+    submit(std::move(job), counter);
+    return counter;
+}
+
+void JobSystem::submit(std::function<void()> job, const JobHandle& counter) {
+    counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+    push(Job{std::move(job), counter});
+}
+
+JobHandle JobSystem::then(const JobHandle& dependency, std::function<void()> continuation) {
+    JobHandle counter = std::make_shared<JobCounter>();
+    // counted up front so waiting on the continuation also waits for the dependency
+    counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    auto queue = [this, counter, continuation = std::move(continuation)]() { push(Job{continuation, counter}); };
+
+    {
+        std::lock_guard<std::mutex> lock(dependency->m_continuationMutex);
+        if (!dependency->is_done()) {
+            dependency->m_continuations.emplace_back(std::move(queue));
+            return counter;
+        }
+    }
+    queue();
+    return counter;
+}
+
+void JobSystem::wait(const JobHandle& counter) {
+    while (!counter->is_done()) {
+        Job job;
+        if (try_pop(job)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallel_for(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    if (count <= grainSize) {
+        func(0, count);
+        return;
+    }
+
+    JobHandle counter = std::make_shared<JobCounter>();
+    for (size_t begin = grainSize; begin < count; begin += grainSize) {
+        size_t end = std::min(begin + grainSize, count);
+        submit([&func, begin, end]() { func(begin, end); }, counter);
+    }
+    // the calling thread takes the first range itself
+    func(0, grainSize);
+    wait(counter);
+}
+
+void JobSystem::push(Job job) {
+    size_t index = s_workerIndex >= 0 ? static_cast<size_t>(s_workerIndex)
+                                      : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    {
+        // counted before the job is visible so a thief can never take the count below zero, and under the wake
+        // mutex so a worker between its empty check and its wait can not miss the notify
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_queuedJobs.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->jobs.emplace_back(std::move(job));
+    }
+    m_wakeCondition.notify_one();
+}
+
+bool JobSystem::try_pop(Job& job) {
+    const size_t queueCount = m_queues.size();
+
+    if (s_workerIndex >= 0) {
+        WorkQueue& own = *m_queues[s_workerIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    size_t start = s_workerIndex >= 0 ? static_cast<size_t>(s_workerIndex) + 1 : 0;
+    for (size_t i = 0; i < queueCount; ++i) {
+        WorkQueue& victim = *m_queues[(start + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(Job& job) {
+    job.task();
+    finish(job.counter);
+}
+
+void JobSystem::finish(const JobHandle& counter) {
+    if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_continuationMutex);
+        continuations.swap(counter->m_continuations);
+    }
+    for (auto& continuation : continuations) {
+        continuation();
+    }
+}
+
+void JobSystem::worker_loop(uint32_t index) {
+    s_workerIndex = static_cast<int32_t>(index);
+
+    while (true) {
+        Job job;
+        if (try_pop(job)) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.wait(lock, [this]() { return !m_running || m_queuedJobs.load() > 0; });
+        if (!m_running) {
+            return;
+        }
+    }
+}
+
+}  // namespace knot
@@ -31,6 +31,22 @@ void Mesh::on_destroy() {
     log::info("removed mesh : {}", m_fullPath);
 }
 
+std::vector<vec3> Mesh::get_positions() const {
+    std::vector<vec3> positions;
+    positions.reserve(m_vertexLayout.size());
+    for (const VertexLayout& vertex : m_vertexLayout) {
+        positions.emplace_back(vertex.m_x, vertex.m_y, vertex.m_z);
+    }
+    return positions;
+}
+
+std::vector<uint32_t> Mesh::get_indices() const {
+    if (!m_indexBuffer) {
+        return {};
+    }
+    return std::vector<uint32_t>(m_indexBuffer->get_indices().begin(), m_indexBuffer->get_indices().end());
+}
+
 void Mesh::create_cube() {
     std::vector<unsigned int> tempIndex = {
         0,  2,  1,  1,  2,  3,  4,  5,  6,  5,  7,  6,
@@ -1,16 +1,77 @@
+#include <knoting/assert.h>
 #include <knoting/components.h>
 #include <knoting/engine.h>
 #include <knoting/physics.h>
 #include <knoting/scene.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+
 PxDefaultAllocator g_Allocator;
 PxDefaultErrorCallback g_ErrorCallback;
 
 namespace knot {
+
+// pooled game objects keep their actor in the scene with simulation disabled, hide them from queries as well
+class ActiveActorQueryFilter : public PxQueryFilterCallback {
+   public:
+    PxQueryHitType::Enum preFilter(const PxFilterData& filterData,
+                                   const PxShape* shape,
+                                   const PxRigidActor* actor,
+                                   PxHitFlags& queryFlags) override {
+        if (actor->getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION)) {
+            return PxQueryHitType::eNONE;
+        }
+        return PxQueryHitType::eBLOCK;
+    }
+
+    PxQueryHitType::Enum postFilter(const PxFilterData& filterData, const PxQueryHit& hit) override {
+        return PxQueryHitType::eBLOCK;
+    }
+};
+
+static ActiveActorQueryFilter s_activeActorFilter;
+
+// the CCT also collides controllers with each other outside the scene queries, parked ones drop out of that too
+class ActiveControllerFilter : public PxControllerFilterCallback {
+   public:
+    bool filter(const PxController& a, const PxController& b) override {
+        return !a.getActor()->getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION) &&
+               !b.getActor()->getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION);
+    }
+};
+
+static ActiveControllerFilter s_activeControllerFilter;
+
+// MBP drops objects that leave every region from collision until they come back
+class OutOfBoundsReporter : public PxBroadPhaseCallback {
+   public:
+    void onObjectOutOfBounds(PxShape& shape, PxActor& actor) override {
+        log::warn("physics entity {} left the broadphase regions", entt::to_integral(Physics::get_actor_entity(actor)));
+    }
+
+    void onObjectOutOfBounds(PxAggregate& aggregate) override {
+        log::warn("physics aggregate of {} actors left the broadphase regions", aggregate.getNbActors());
+    }
+};
+
+static OutOfBoundsReporter s_outOfBoundsReporter;
+
+// below this many queries a batch runs on the calling thread
+constexpr size_t QUERY_GRAIN_SIZE = 32;
+
 Physics::Physics(Engine& engine)
     : m_engine(engine), m_Physics(nullptr), m_Scene(nullptr), m_Foundation(nullptr), m_Dispatcher(nullptr) {}
 
-Physics::~Physics() {}
+Physics::~Physics() {
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
 
 void Physics::on_awake() {
     m_Foundation = std::make_shared<PxFoundation_ptr_wrapper>(
@@ -18,57 +79,947 @@ void Physics::on_awake() {
 
     m_Physics = std::make_shared<PxPhysics_ptr_wrapper>(
         PxCreatePhysics(PX_PHYSICS_VERSION, *m_Foundation->get(), PxTolerancesScale(), false, NULL));
+    m_cache = std::make_shared<PhysicsCache>(m_Physics);
+    m_cooker = std::make_shared<CollisionCooker>(*m_Foundation->get(), *m_Physics->get());
     constexpr float defalut_gravity = -9.81f;
     PxSceneDesc sceneDesc(m_Physics->get()->getTolerancesScale());
     sceneDesc.gravity = PxVec3(0, defalut_gravity, 0);
-    m_Dispatcher = std::make_shared<PxDispatcher_ptr_wrapper>(PxDefaultCpuDispatcherCreate(2));
-    sceneDesc.cpuDispatcher = m_Dispatcher->get();
-    sceneDesc.filterShader = PxDefaultSimulationFilterShader;
+    m_Dispatcher = std::make_shared<PxJobDispatcher>(*m_engine.get_job_system().lock(),
+                                                     m_engine.get_settings().physicsWorkerCount);
+    sceneDesc.cpuDispatcher = m_Dispatcher.get();
+    // the matrix is copied into the scene, set_layer_collision pushes every later change
+    sceneDesc.filterShader = collision_layer_filter_shader;
+    sceneDesc.filterShaderData = &m_collisionMatrix;
+    sceneDesc.filterShaderDataSize = sizeof(CollisionMatrix);
+    m_events = std::make_shared<PhysicsEventBuffer>(m_engine.get_settings().physicsEventCapacity);
+    sceneDesc.simulationEventCallback = m_events.get();
+    // fetchResults reports the actors that moved, the transform sync skips everything else
+    sceneDesc.flags |= PxSceneFlag::eENABLE_ACTIVE_ACTORS;
+
+    const EngineSettings& settings = m_engine.get_settings();
+    switch (settings.physicsBroadPhase) {
+        case PhysicsBroadPhase::MBP:
+            sceneDesc.broadPhaseType = PxBroadPhaseType::eMBP;
+            break;
+        case PhysicsBroadPhase::ABP:
+            sceneDesc.broadPhaseType = PxBroadPhaseType::eABP;
+            break;
+        default:
+            sceneDesc.broadPhaseType = PxBroadPhaseType::eSAP;
+            break;
+    }
+    sceneDesc.broadPhaseCallback = &s_outOfBoundsReporter;
+    if (settings.physicsEnhancedDeterminism) {
+        sceneDesc.flags |= PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+    }
     m_Scene = std::make_shared<PxScene_ptr_wrapper>(m_Physics->get()->createScene(sceneDesc));
+    if (settings.physicsBroadPhase == PhysicsBroadPhase::MBP) {
+        set_broadphase_regions(settings.physicsWorldMin, settings.physicsWorldMax, settings.physicsRegionSubdivisions);
+    }
+
+    set_step_rate(m_engine.get_settings().physicsStepRate);
+    set_max_steps_per_frame(m_engine.get_settings().physicsMaxStepsPerFrame);
+    set_lod_radii(settings.physicsSleepRadius, settings.physicsDisableRadius);
+    set_statistics_log_interval(settings.physicsStatisticsLogInterval);
+
+    m_controllerManager = PxCreateControllerManager(*m_Scene->get());
+    m_obstacles = m_controllerManager->createObstacleContext();
+
+    m_serializationRegistry = PxSerialization::createSerializationRegistry(*m_Physics->get());
+    m_snapshots =
+        std::make_shared<PhysicsSnapshotRing>(settings.physicsSnapshotFrames, settings.physicsSnapshotBodyCapacity);
+
+    s_instance = this;
 }
 
-void Physics::on_update(double m_deltatime) {}
+void Physics::on_update(double m_deltatime) {
+    // a step kicked by a caller outside the frame loop has to land before the accumulator runs more
+    end_simulation();
+    dispatch_events();
 
-void Physics::on_fixed_update() {
-    constexpr float timestep = 1.0 / 120.0f;
-    m_Scene->get()->simulate(timestep);
-    m_Scene->get()->fetchResults(true);
-    update_info_to_transform();
+    // actor flags and velocities can only change while no step runs
+    auto sceneOpt = Scene::get_active_scene();
+    if (sceneOpt) {
+        update_lod(sceneOpt.value());
+    }
+
+    m_accumulator += m_deltatime;
+    uint32_t steps = static_cast<uint32_t>(m_accumulator / m_timestep);
+    if (steps > m_maxStepsPerFrame) {
+        log::debug("physics dropped {} steps", steps - m_maxStepsPerFrame);
+        steps = m_maxStepsPerFrame;
+        m_accumulator = m_timestep * steps;
+    }
+    m_accumulator -= m_timestep * steps;
+
+    // all but the last step run here, the last one overlaps with the rest of the frame
+    for (uint32_t i = 1; i < steps; ++i) {
+        begin_simulation();
+        end_simulation();
+        dispatch_events();
+    }
+    // once per frame, from the newest step fetched so far
+    if (m_debugVisualization && m_debugGeometryStale) {
+        capture_debug_geometry();
+    }
+    if (steps > 0) {
+        begin_simulation();
+    }
+
+    // the rendered pose trails the simulation by one step, so the leftover time blends the last two steps
+    m_interpolationAlpha = static_cast<float>(m_accumulator / m_timestep);
+
+    log_statistics(m_deltatime);
 }
 
-void Physics::on_late_update() {}
+void Physics::on_fixed_update() {}
 
-void Physics::on_destroy() {}
+void Physics::on_late_update() {
+    end_simulation();
+    dispatch_events();
+}
 
-void Physics::update_info_to_transform() {
-    // update the global pos to transform component
+void Physics::on_destroy() {
+    end_simulation();
+    // the completion task of the last step may still sit in the dispatcher
+    while (m_stepTimer.is_running()) {
+        std::this_thread::yield();
+    }
+    release_scene_objects();
+    if (m_controllerManager) {
+        // takes the obstacle context and every controller with it
+        m_controllerManager->release();
+        m_controllerManager = nullptr;
+        m_obstacles = nullptr;
+    }
+    if (m_serializationRegistry) {
+        m_serializationRegistry->release();
+        m_serializationRegistry = nullptr;
+    }
+}
 
+void Physics::release_scene_objects() {
+    using namespace components;
     auto sceneOpt = Scene::get_active_scene();
     if (!sceneOpt) {
         return;
     }
-    Scene& scene = sceneOpt.value();
+    entt::registry& registry = sceneOpt->get().get_registry();
+
+    // controllers before the manager, aggregates before the actors they hold
+    for (auto [e, character] : registry.view<CharacterController>().each()) {
+        character.on_destroy();
+    }
+    for (auto [e, aggregate] : registry.view<PhysicsAggregate>().each()) {
+        aggregate.on_destroy();
+    }
+    for (auto [e, controller] : registry.view<RigidController>().each()) {
+        controller.on_destroy();
+    }
+    // waits for its chunk builds, which cook through the module
+    for (auto [e, terrain] : registry.view<Terrain>().each()) {
+        terrain.on_destroy();
+    }
+    for (auto [e, rigidbody] : registry.view<RigidBody>().each()) {
+        rigidbody.on_destroy();
+    }
+    for (auto [e, shape] : registry.view<Shape>().each()) {
+        shape.on_destroy();
+    }
+    for (auto [e, material] : registry.view<PhysicsMaterial>().each()) {
+        material.on_destroy();
+    }
+}
+
+void Physics::begin_simulation() {
+    if (m_simulating) {
+        return;
+    }
+    move_controllers();
+
+    // runs on the job workers while the frame extracts and submits the poses of the previous step
+    PxScene* scene = m_Scene->get();
+    PxTaskManager* taskManager = scene->getTaskManager();
+    const bool timed = taskManager && m_stepTimer.start(*taskManager);
+    auto start = std::chrono::high_resolution_clock::now();
+    scene->simulate(static_cast<PxReal>(m_timestep), timed ? &m_stepTimer : nullptr);
+    auto stop = std::chrono::high_resolution_clock::now();
+    if (timed) {
+        // from here on only the step holds the timer, it runs when the workers are done
+        m_stepTimer.removeReference();
+    }
+    m_statistics.simulateMs = std::chrono::duration<double, std::milli>(stop - start).count();
+    m_simulating = true;
+}
+
+void Physics::end_simulation() {
+    if (!m_simulating) {
+        return;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    m_Scene->get()->fetchResults(true);
+    auto stop = std::chrono::high_resolution_clock::now();
+    m_statistics.stepMs = m_stepTimer.get_step_ms();
+    m_simulating = false;
+    ++m_stepIndex;
+    m_debugGeometryStale = true;
+    record_statistics(std::chrono::duration<double, std::milli>(stop - start).count());
+    record_active_actors();
+    // events wait in the buffer for the next delivery point, see subscribe_events
+    m_events->clear_removed_actors();
+}
+
+void Physics::set_step_rate(float stepsPerSecond) {
+    KNOTING_ASSERT_MESSAGE(stepsPerSecond > 0.0f, "physics step rate has to be positive");
+    m_timestep = 1.0 / stepsPerSecond;
+}
+
+void Physics::set_max_steps_per_frame(uint32_t maxSteps) {
+    m_maxStepsPerFrame = std::max(maxSteps, 1u);
+}
+
+void Physics::add_actors(PxRigidActor* const* actors, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    // pruning structures can not be merged into a scene that is mid step
+    end_simulation();
+
+    PxPruningStructure* pruningStructure =
+        m_Physics->get()->createPruningStructure(actors, static_cast<PxU32>(count));
+    if (pruningStructure) {
+        m_Scene->get()->addActors(*pruningStructure);
+        pruningStructure->release();
+    } else {
+        // creation fails when an actor has no scene query shape, insertion is still batched without the trees
+        log::warn("physics could not build a pruning structure for {} actors", count);
+        m_Scene->get()->addActors(actors, static_cast<PxU32>(count));
+    }
+}
+
+void Physics::set_layer_collision(CollisionLayer a, CollisionLayer b, bool collide) {
+    m_collisionMatrix.set_collision(a, b, collide);
+    refresh_filtering();
+}
+
+void Physics::set_lod_radii(float sleepRadius, float disableRadius) {
+    m_lodSleepRadius = std::max(sleepRadius, 0.0f);
+    m_lodDisableRadius = std::max(disableRadius, 0.0f);
+}
+
+void Physics::update_lod(Scene& scene) {
+    using namespace components;
     entt::registry& registry = scene.get_registry();
 
-    auto entities = registry.view<components::Transform, components::RigidBody>();
+    // with the lod off only bodies it parked earlier still need their state back
+    const bool lodEnabled = m_lodSleepRadius > 0.0f || m_lodDisableRadius > 0.0f;
+    if (!lodEnabled && registry.view<PhysicsLodParked>().empty()) {
+        return;
+    }
+
+    m_lodFoci.clear();
+    if (lodEnabled) {
+        for (auto [e, transform] : registry.view<Transform, EditorCamera>(entt::exclude<Inactive>).each()) {
+            m_lodFoci.emplace_back(transform.get_position());
+        }
+        for (auto [e, transform] : registry.view<Transform, PhysicsLodFocus>(entt::exclude<Inactive>).each()) {
+            m_lodFoci.emplace_back(transform.get_position());
+        }
+    }
+
+    // nothing to measure against, every parked body comes back
+    const bool hasFoci = !m_lodFoci.empty();
+    const float sleepDistance2 = m_lodSleepRadius * m_lodSleepRadius;
+    const float disableDistance2 = m_lodDisableRadius * m_lodDisableRadius;
 
-    for (auto& e : entities) {
-        auto goOpt = scene.get_game_object_from_handle(e);
+    auto bodies = registry.view<RigidBody, Transform>(entt::exclude<Inactive>);
+    for (auto [e, rigidbody, transform] : bodies.each()) {
+        PxRigidDynamic* dynamic = rigidbody.get_dynamic();
+        if (!dynamic || dynamic->getRigidBodyFlags().isSet(PxRigidBodyFlag::eKINEMATIC)) {
+            continue;
+        }
+
+        const vec3 position = transform.get_position();
+        float distance2 = std::numeric_limits<float>::max();
+        for (const vec3& focus : m_lodFoci) {
+            const vec3 offset = position - focus;
+            distance2 = std::min(distance2, glm::dot(offset, offset));
+        }
 
-        if (!goOpt) {
+        const bool isDisabled = dynamic->getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION);
+        const bool disable = hasFoci && m_lodDisableRadius > 0.0f && distance2 > disableDistance2;
+        const bool sleep = !disable && hasFoci && m_lodSleepRadius > 0.0f && distance2 > sleepDistance2;
+
+        PhysicsLodParked* parked = registry.try_get<PhysicsLodParked>(e);
+        // a pooled body may have been switched back on elsewhere, its saved velocities are stale then
+        if (parked && parked->disabled && !isDisabled) {
+            registry.remove<PhysicsLodParked>(e);
+            parked = nullptr;
+        }
+
+        if (disable) {
+            if (!isDisabled) {
+                // a body already parked asleep keeps the velocities it had before, asleep they read zero
+                PxVec3 linear = parked ? parked->linearVelocity : dynamic->getLinearVelocity();
+                PxVec3 angular = parked ? parked->angularVelocity : dynamic->getAngularVelocity();
+                registry.emplace_or_replace<PhysicsLodParked>(e, linear, angular, true);
+                rigidbody.set_simulation_enabled(false);
+            }
             continue;
         }
 
-        GameObject go = goOpt.value();
-        components::Transform& transform = registry.get<components::Transform>(go.get_handle());
-        components::RigidBody& rigidbody = registry.get<components::RigidBody>(go.get_handle());
-        vec3 pos = rigidbody.get_position();
-        quat r = rigidbody.get_rotation();
+        if (parked && parked->disabled) {
+            // back into the simulation, asleep or awake depending on the band it came into
+            rigidbody.set_simulation_enabled(true);
+            parked->disabled = false;
+        }
 
-        transform.set_position(rigidbody.get_position());
+        if (sleep) {
+            // putToSleep zeroes the velocities, they are kept until the body is near again. A body woken by a contact
+            // from a nearer one parks again with the velocities that contact gave it.
+            if (!dynamic->isSleeping()) {
+                if (!parked) {
+                    registry.emplace<PhysicsLodParked>(e, dynamic->getLinearVelocity(), dynamic->getAngularVelocity());
+                } else if (dynamic->getLinearVelocity().magnitudeSquared() > 0.0f ||
+                           dynamic->getAngularVelocity().magnitudeSquared() > 0.0f) {
+                    parked->linearVelocity = dynamic->getLinearVelocity();
+                    parked->angularVelocity = dynamic->getAngularVelocity();
+                }
+                dynamic->putToSleep();
+            }
+            continue;
+        }
+
+        if (parked) {
+            dynamic->wakeUp();
+            dynamic->setLinearVelocity(parked->linearVelocity);
+            dynamic->setAngularVelocity(parked->angularVelocity);
+            registry.remove<PhysicsLodParked>(e);
+        }
+    }
+}
 
-        transform.set_rotation(rigidbody.get_rotation());
+uint64_t Physics::capture_snapshot(bool full) {
+    end_simulation();
+
+    PhysicsSnapshot& snapshot = m_snapshots->push(m_stepIndex);
+    snapshot.accumulator = m_accumulator;
+    auto sceneOpt = Scene::get_active_scene();
+    if (sceneOpt) {
+        snapshot.capture_bodies(sceneOpt->get().get_registry());
+        snapshot.capture_controllers(sceneOpt->get().get_registry());
+    }
+
+    if (full) {
+        serialize_scene(snapshot.collection);
+    }
+    return m_stepIndex;
+}
+
+bool Physics::serialize_scene(std::vector<uint8_t>& bytes) {
+    if (!m_serializationRegistry) {
+        return false;
+    }
+    PxCollection* collection = PxCollectionExt::createCollection(*m_Scene->get());
+    // shapes and materials the actors reference go in as well
+    PxSerialization::complete(*collection, *m_serializationRegistry);
+    PxDefaultMemoryOutputStream stream;
+    const bool serialized =
+        PxSerialization::serializeCollectionToBinary(stream, *collection, *m_serializationRegistry);
+    if (serialized) {
+        bytes.assign(stream.getData(), stream.getData() + stream.getSize());
+    } else {
+        log::warn("physics could not serialize the scene of step {}", m_stepIndex);
+    }
+    collection->release();
+    return serialized;
+}
+
+bool Physics::restore_snapshot(uint64_t step) {
+    const PhysicsSnapshot* snapshot = m_snapshots->find(step);
+    if (!snapshot) {
+        log::warn("physics snapshot of step {} is no longer kept", step);
+        return false;
+    }
+    end_simulation();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t restored = 0;
+    size_t restoredControllers = 0;
+    auto sceneOpt = Scene::get_active_scene();
+    if (sceneOpt) {
+        restored = snapshot->restore_bodies(sceneOpt->get().get_registry());
+        restoredControllers = snapshot->restore_controllers(sceneOpt->get().get_registry());
+    }
+    m_stepIndex = snapshot->step;
+    m_accumulator = snapshot->accumulator;
+    m_interpolationAlpha = static_cast<float>(m_accumulator / m_timestep);
+    // the restore already wrote the transforms, nothing of the abandoned steps is left to sync
+    m_lastStepEntities.clear();
+    m_lastStepMoved.clear();
+    m_pendingSyncEntities.clear();
+    m_events->clear();
+    m_snapshots->truncate_after(step);
+    auto stop = std::chrono::high_resolution_clock::now();
+
+    log::debug("physics restored step {}, {} bodies and {} controllers in {:.1f} us", step, restored,
+               restoredControllers, std::chrono::duration<double, std::micro>(stop - start).count());
+    return true;
+}
+
+bool Physics::export_snapshot(uint64_t step, const std::string& path) const {
+    const PhysicsSnapshot* snapshot = m_snapshots->find(step);
+    if (!snapshot || snapshot->collection.empty()) {
+        log::error("physics has no full snapshot of step {} to export", step);
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        log::error("physics could not open {} to export step {}", path, step);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(snapshot->collection.data()),
+               static_cast<std::streamsize>(snapshot->collection.size()));
+    return true;
+}
+
+PhysicsDeterminismReport Physics::check_determinism(uint32_t steps) {
+    PhysicsDeterminismReport report;
+    report.steps = steps;
+
+    // a local snapshot, the rewind ring keeps its rollback frames
+    end_simulation();
+    PhysicsSnapshot snapshot;
+    snapshot.step = m_stepIndex;
+    if (!serialize_scene(snapshot.collection)) {
+        return report;
+    }
+
+    // two fresh scenes deserialized from the same bytes start with the same contact caches, sleep counters and pair
+    // order, so any difference comes from the simulation itself
+    std::vector<PxTransform> first;
+    std::vector<PxTransform> second;
+    if (!step_scratch_scene(snapshot.collection, steps, first) ||
+        !step_scratch_scene(snapshot.collection, steps, second)) {
+        return report;
+    }
+    report.bodies = first.size();
+
+    for (size_t i = 0; i < first.size(); ++i) {
+        const float positionError = (first[i].p - second[i].p).magnitude();
+        const float rotationError = first[i].q.getAngle(second[i].q);
+        if (std::memcmp(&first[i], &second[i], sizeof(PxTransform)) != 0) {
+            ++report.mismatches;
+        }
+        report.maxPositionError = std::max(report.maxPositionError, positionError);
+        report.maxRotationError = std::max(report.maxRotationError, rotationError);
+    }
+
+    if (report.mismatches > 0) {
+        log::warn("physics diverged over {} steps, {} of {} bodies differ, up to {} m and {} rad", steps,
+                  report.mismatches, report.bodies, report.maxPositionError, report.maxRotationError);
+    } else {
+        log::debug("physics is deterministic over {} steps for {} bodies", steps, report.bodies);
+    }
+    return report;
+}
+
+bool Physics::step_scratch_scene(const std::vector<uint8_t>& collection,
+                                 uint32_t steps,
+                                 std::vector<PxTransform>& poses) {
+    PxScene* live = m_Scene->get();
+    PxSceneDesc sceneDesc(m_Physics->get()->getTolerancesScale());
+    sceneDesc.gravity = live->getGravity();
+    sceneDesc.cpuDispatcher = m_Dispatcher.get();
+    sceneDesc.filterShader = collision_layer_filter_shader;
+    sceneDesc.filterShaderData = &m_collisionMatrix;
+    sceneDesc.filterShaderDataSize = sizeof(CollisionMatrix);
+    sceneDesc.broadPhaseType = live->getBroadPhaseType();
+    sceneDesc.flags |= PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+    PxScene* scene = m_Physics->get()->createScene(sceneDesc);
+    if (!scene) {
+        log::error("physics could not create a scratch scene");
+        return false;
     }
+
+    std::vector<PxBroadPhaseRegionInfo> regions(live->getNbBroadPhaseRegions());
+    live->getBroadPhaseRegions(regions.data(), static_cast<PxU32>(regions.size()));
+    for (const PxBroadPhaseRegionInfo& region : regions) {
+        scene->addBroadPhaseRegion(region.region);
+    }
+
+    // binary collections are deserialized in place, into aligned memory that outlives the objects
+    std::vector<uint8_t> memory(collection.size() + PX_SERIAL_FILE_ALIGN);
+    const uintptr_t alignMask = PX_SERIAL_FILE_ALIGN - 1;
+    void* aligned = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(memory.data()) + alignMask) & ~alignMask);
+    std::memcpy(aligned, collection.data(), collection.size());
+
+    PxCollection* objects = PxSerialization::createCollectionFromBinary(aligned, *m_serializationRegistry);
+    if (!objects) {
+        log::error("physics could not deserialize the snapshot collection");
+        scene->release();
+        return false;
+    }
+    scene->addCollection(*objects);
+
+    for (uint32_t i = 0; i < steps; ++i) {
+        scene->simulate(static_cast<PxReal>(m_timestep));
+        scene->fetchResults(true);
+    }
+
+    // both deserializations list the objects in the same order
+    poses.clear();
+    for (PxU32 i = 0; i < objects->getNbObjects(); ++i) {
+        if (const PxRigidDynamic* dynamic = objects->getObject(i).is<PxRigidDynamic>()) {
+            poses.emplace_back(dynamic->getGlobalPose());
+        }
+    }
+
+    PxCollectionExt::releaseObjects(*objects);
+    objects->release();
+    scene->release();
+    return true;
+}
+
+void Physics::set_debug_visualization(bool enabled) {
+    end_simulation();
+    m_debugVisualization = enabled;
+
+    PxScene* scene = m_Scene->get();
+    // the scale gates every other parameter, 0 skips the debug geometry generation inside the step entirely
+    scene->setVisualizationParameter(PxVisualizationParameter::eSCALE, enabled ? 1.0f : 0.0f);
+    if (enabled && scene->getVisualizationParameter(PxVisualizationParameter::eCOLLISION_SHAPES) == 0.0f) {
+        scene->setVisualizationParameter(PxVisualizationParameter::eCOLLISION_SHAPES, 1.0f);
+    }
+    if (enabled) {
+        capture_debug_geometry();
+    } else {
+        m_debugLines.clear();
+        m_debugTriangles.clear();
+    }
+}
+
+void Physics::set_debug_parameter(PxVisualizationParameter::Enum parameter, float value) {
+    end_simulation();
+    m_Scene->get()->setVisualizationParameter(parameter, value);
+}
+
+// PhysX colors are ARGB, bgfx reads the packed color as ABGR
+static uint32_t argb_to_abgr(PxU32 argb) {
+    return (argb & 0xff00ff00) | ((argb & 0x00ff0000) >> 16) | ((argb & 0x000000ff) << 16);
+}
+
+static PhysicsDebugVertex to_debug_vertex(const PxVec3& position, PxU32 color) {
+    return PhysicsDebugVertex{position.x, position.y, position.z, argb_to_abgr(color)};
+}
+
+void Physics::capture_debug_geometry() {
+    const PxRenderBuffer& buffer = m_Scene->get()->getRenderBuffer();
+    const PxDebugLine* lines = buffer.getLines();
+    const PxDebugTriangle* triangles = buffer.getTriangles();
+
+    // resize keeps the capacity, after the first frames this never allocates
+    m_debugLines.resize(buffer.getNbLines() * 2);
+    m_debugTriangles.resize(buffer.getNbTriangles() * 3);
+    m_debugGeometryStale = false;
+
+    auto jobSystem = m_engine.get_job_system().lock();
+    jobSystem->parallel_for(buffer.getNbLines(), 4096, [this, lines](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_debugLines[i * 2] = to_debug_vertex(lines[i].pos0, lines[i].color0);
+            m_debugLines[i * 2 + 1] = to_debug_vertex(lines[i].pos1, lines[i].color1);
+        }
+    });
+    jobSystem->parallel_for(buffer.getNbTriangles(), 4096, [this, triangles](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_debugTriangles[i * 3] = to_debug_vertex(triangles[i].pos0, triangles[i].color0);
+            m_debugTriangles[i * 3 + 1] = to_debug_vertex(triangles[i].pos1, triangles[i].color1);
+            m_debugTriangles[i * 3 + 2] = to_debug_vertex(triangles[i].pos2, triangles[i].color2);
+        }
+    });
+}
+
+void Physics::set_broadphase_regions(const vec3& worldMin, const vec3& worldMax, uint32_t subdivisions) {
+    PxScene* scene = m_Scene->get();
+    if (scene->getBroadPhaseType() != PxBroadPhaseType::eMBP) {
+        log::warn("physics broadphase regions only apply to MBP");
+        return;
+    }
+    end_simulation();
+
+    for (PxU32 handle : m_broadPhaseRegions) {
+        scene->removeBroadPhaseRegion(handle);
+    }
+    m_broadPhaseRegions.clear();
+
+    subdivisions = std::max(subdivisions, 1u);
+    const PxBounds3 worldBounds(components::RigidBody::vec3_to_PxVec3(worldMin),
+                                components::RigidBody::vec3_to_PxVec3(worldMax));
+    std::vector<PxBounds3> bounds(subdivisions * subdivisions);
+    // y is up, the grid splits x and z
+    PxU32 count = PxBroadPhaseExt::createRegionsFromWorldBounds(bounds.data(), worldBounds, subdivisions, 1);
+    for (PxU32 i = 0; i < count; ++i) {
+        PxBroadPhaseRegion region;
+        region.bounds = bounds[i];
+        region.userData = nullptr;
+        m_broadPhaseRegions.emplace_back(scene->addBroadPhaseRegion(region, true));
+    }
+}
+
+PhysicsEventSubscription Physics::subscribe_events(CollisionLayerMask layers, PhysicsEventCallback callback) {
+    EventSubscriber subscriber;
+    subscriber.id = m_nextSubscription++;
+    subscriber.layers = layers;
+    subscriber.callback = std::move(callback);
+    if (layers != ALL_COLLISION_LAYERS) {
+        subscriber.matching.reserve(m_events->get_capacity());
+    }
+    m_eventSubscribers.emplace_back(std::move(subscriber));
+    update_report_mask();
+    return m_eventSubscribers.back().id;
+}
+
+void Physics::unsubscribe_events(PhysicsEventSubscription subscription) {
+    m_eventSubscribers.erase(std::remove_if(m_eventSubscribers.begin(), m_eventSubscribers.end(),
+                                            [subscription](const EventSubscriber& subscriber) {
+                                                return subscriber.id == subscription;
+                                            }),
+                             m_eventSubscribers.end());
+    update_report_mask();
+}
+
+void Physics::note_removed_actor(const PxRigidActor& actor) {
+    PxShape* shape = nullptr;
+    CollisionLayer layer = 0;
+    if (actor.getShapes(&shape, 1) > 0) {
+        layer = static_cast<CollisionLayer>(shape->getSimulationFilterData().word0);
+    }
+    m_events->note_removed_actor(&actor, get_actor_entity(actor), layer);
+}
+
+void Physics::dispatch_events() {
+    if (m_events->get_count() == 0 && m_events->get_dropped() == 0) {
+        return;
+    }
+    const PhysicsEvent* events = m_events->get_events();
+    const size_t count = m_events->get_count();
+    if (m_events->get_dropped() > 0) {
+        log::warn("physics dropped {} events, the buffer holds {}", m_events->get_dropped(), m_events->get_capacity());
+    }
+
+    for (auto& subscriber : m_eventSubscribers) {
+        if (subscriber.layers == ALL_COLLISION_LAYERS) {
+            subscriber.callback(events, count);
+            continue;
+        }
+
+        // copied into storage reserved at subscription, so filtering never allocates
+        subscriber.matching.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const CollisionLayerMask pairLayers = (1u << events[i].layerA) | (1u << events[i].layerB);
+            if (subscriber.layers & pairLayers) {
+                subscriber.matching.emplace_back(events[i]);
+            }
+        }
+        if (!subscriber.matching.empty()) {
+            subscriber.callback(subscriber.matching.data(), subscriber.matching.size());
+        }
+    }
+    m_events->clear();
+}
+
+void Physics::record_statistics(double fetchResultsMs) {
+    PxSimulationStatistics stats;
+    m_Scene->get()->getSimulationStatistics(stats);
+
+    m_statistics.activeBodies = stats.nbActiveDynamicBodies;
+    m_statistics.activeKinematicBodies = stats.nbActiveKinematicBodies;
+    m_statistics.dynamicBodies = stats.nbDynamicBodies;
+    m_statistics.staticBodies = stats.nbStaticBodies;
+    m_statistics.activeConstraints = stats.nbActiveConstraints;
+    m_statistics.contactPairs = stats.nbDiscreteContactPairsTotal;
+    m_statistics.touchingPairs = stats.nbDiscreteContactPairsWithContacts;
+    m_statistics.newTouches = stats.nbNewTouches;
+    m_statistics.lostTouches = stats.nbLostTouches;
+    m_statistics.broadPhaseAdds = stats.nbBroadPhaseAdds;
+    m_statistics.broadPhaseRemoves = stats.nbBroadPhaseRemoves;
+    m_statistics.fetchResultsMs = fetchResultsMs;
+    ++m_statistics.steps;
+
+    ++m_statisticsSteps;
+    m_statisticsSimulateMs += m_statistics.simulateMs;
+    m_statisticsFetchMs += fetchResultsMs;
+    m_statisticsStepMs += m_statistics.stepMs;
+    m_statisticsPeakStepMs = std::max(m_statisticsPeakStepMs, m_statistics.stepMs);
+    m_statisticsContactPairs += m_statistics.contactPairs;
+}
+
+void Physics::log_statistics(double deltaTime) {
+    if (m_statisticsLogInterval <= 0.0f) {
+        return;
+    }
+    m_statisticsTime += deltaTime;
+    if (m_statisticsTime < m_statisticsLogInterval || m_statisticsSteps == 0) {
+        return;
+    }
+
+    const double steps = static_cast<double>(m_statisticsSteps);
+    log::debug(
+        "physics {} steps, step {:.3f} ms, peak {:.3f} ms, simulate {:.3f} ms, fetchResults {:.3f} ms, {} pairs per "
+        "step, {} of {} bodies active, {} constraints",
+        m_statisticsSteps, m_statisticsStepMs / steps, m_statisticsPeakStepMs, m_statisticsSimulateMs / steps,
+        m_statisticsFetchMs / steps, m_statisticsContactPairs / m_statisticsSteps, m_statistics.activeBodies,
+        m_statistics.dynamicBodies, m_statistics.activeConstraints);
+
+    m_statisticsTime = 0.0;
+    m_statisticsSteps = 0;
+    m_statisticsSimulateMs = 0.0;
+    m_statisticsStepMs = 0.0;
+    m_statisticsFetchMs = 0.0;
+    m_statisticsPeakStepMs = 0.0;
+    m_statisticsContactPairs = 0;
+}
+
+void Physics::update_report_mask() {
+    CollisionLayerMask reportMask = 0;
+    for (const auto& subscriber : m_eventSubscribers) {
+        reportMask |= subscriber.layers;
+    }
+    if (reportMask == m_collisionMatrix.reportMask) {
+        return;
+    }
+    m_collisionMatrix.reportMask = reportMask;
+    refresh_filtering();
+}
+
+void Physics::refresh_filtering() {
+    // filter data can only change between steps, and pairs that were already killed or kept need filtering again
+    end_simulation();
+    PxScene* scene = m_Scene->get();
+    scene->setFilterShaderData(&m_collisionMatrix, sizeof(CollisionMatrix));
+
+    const PxActorTypeFlags types = PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC;
+    std::vector<PxActor*> actors(scene->getNbActors(types));
+    scene->getActors(types, actors.data(), static_cast<PxU32>(actors.size()));
+    for (PxActor* actor : actors) {
+        scene->resetFiltering(*actor);
+    }
+}
+
+void Physics::set_actor_entity(PxActor& actor, entt::entity entity) {
+    actor.userData = reinterpret_cast<void*>(static_cast<uintptr_t>(entt::to_integral(entity)));
+}
+
+entt::entity Physics::get_actor_entity(const PxActor& actor) {
+    return static_cast<entt::entity>(reinterpret_cast<uintptr_t>(actor.userData));
+}
+
+void Physics::record_active_actors() {
+    auto sceneOpt = Scene::get_active_scene();
+    if (!sceneOpt) {
+        return;
+    }
+    entt::registry& registry = sceneOpt->get().get_registry();
+
+    auto find_rigidbody = [&registry](entt::entity e) -> components::RigidBody* {
+        if (!registry.valid(e) || registry.all_of<components::Inactive>(e)) {
+            return nullptr;
+        }
+        return registry.try_get<components::RigidBody>(e);
+    };
+
+    // the previous step still has to reach the transforms if a later step of the frame does not touch it
+    m_pendingSyncEntities.insert(m_pendingSyncEntities.end(), m_lastStepEntities.begin(), m_lastStepEntities.end());
+    m_lastStepEntities.clear();
+
+    std::vector<entt::entity> moved;
+    PxU32 count = 0;
+    PxActor** actors = m_Scene->get()->getActiveActors(count);
+    moved.reserve(count);
+    for (PxU32 i = 0; i < count; ++i) {
+        entt::entity e = get_actor_entity(*actors[i]);
+        if (components::RigidBody* rigidbody = find_rigidbody(e)) {
+            rigidbody->record_pose();
+            moved.emplace_back(e);
+        }
+    }
+    std::sort(moved.begin(), moved.end());
+
+    // bodies that came to rest this step still blend from their last moving pose, one more record settles them
+    for (entt::entity e : m_lastStepMoved) {
+        if (std::binary_search(moved.begin(), moved.end(), e)) {
+            continue;
+        }
+        if (components::RigidBody* rigidbody = find_rigidbody(e)) {
+            rigidbody->record_pose();
+            m_lastStepEntities.emplace_back(e);
+        }
+    }
+
+    m_lastStepEntities.insert(m_lastStepEntities.end(), moved.begin(), moved.end());
+    m_lastStepMoved = std::move(moved);
+}
+
+void Physics::move_controllers() {
+    if (!m_controllerManager || m_controllerManager->getNbControllers() == 0) {
+        return;
+    }
+    auto sceneOpt = Scene::get_active_scene();
+    if (!sceneOpt) {
+        return;
+    }
+    entt::registry& registry = sceneOpt->get().get_registry();
+
+    const float dt = static_cast<float>(m_timestep);
+    const PxVec3 gravity = m_Scene->get()->getGravity();
+    // one linear pass over the packed controllers, the query filter skips pooled and lod parked actors, the
+    // transforms follow in update_info_to_transform
+    auto controllers = registry.view<components::CharacterController>(entt::exclude<components::Inactive>);
+    for (auto [e, controller] : controllers.each()) {
+        controller.move(dt, gravity, m_collisionMatrix, &s_activeActorFilter, &s_activeControllerFilter, m_obstacles);
+    }
+
+    // characters push each other apart once all of them moved
+    m_controllerManager->computeInteractions(dt, &s_activeControllerFilter);
+}
+
+void Physics::update_info_to_transform(Scene& scene) {
+    // update the global pos to transform component of the bodies the last steps moved
+    entt::registry& registry = scene.get_registry();
+
+    std::vector<entt::entity>& entities = m_pendingSyncEntities;
+    entities.insert(entities.end(), m_lastStepEntities.begin(), m_lastStepEntities.end());
+    std::sort(entities.begin(), entities.end());
+    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+    // reads the cached step poses, never the PxScene, so it is safe while the next step simulates
+    const float alpha = m_interpolationAlpha;
+    // every entity only touches its own components, so the copy is split across the workers
+    m_engine.get_job_system().lock()->parallel_for(
+        entities.size(), 256, [&registry, &entities, alpha](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                entt::entity e = entities[i];
+                if (!registry.valid(e) || !registry.all_of<components::RigidBody, components::Transform>(e)) {
+                    continue;
+                }
+                auto [rigidbody, transform] = registry.get<components::RigidBody, components::Transform>(e);
+                transform.set_position(rigidbody.get_interpolated_position(alpha));
+                transform.set_rotation(rigidbody.get_interpolated_rotation(alpha));
+            }
+        });
+
+    // controllers are few and move every step, they blend the same way as the bodies
+    auto controllers = registry.view<components::CharacterController, components::Transform>(
+        entt::exclude<components::Inactive>);
+    for (auto [e, controller, transform] : controllers.each()) {
+        transform.set_position(controller.get_interpolated_foot_position(alpha));
+    }
+
+    entities.clear();
+}
+
+void Physics::update_raycasts(Scene& scene) {
+    auto raycasts = scene.get_registry().view<components::Raycast>(entt::exclude<components::Inactive>);
+
+    // gathered into reused arrays so the whole pass is one batch split across the workers
+    m_raycastEntities.assign(raycasts.begin(), raycasts.end());
+    m_raycastQueries.resize(m_raycastEntities.size());
+    m_raycastHits.resize(m_raycastEntities.size());
+    for (size_t i = 0; i < m_raycastEntities.size(); ++i) {
+        m_raycastQueries[i] = raycasts.get<components::Raycast>(m_raycastEntities[i]).get_query();
+    }
+
+    raycast_batch(m_raycastQueries.data(), m_raycastHits.data(), m_raycastQueries.size());
+
+    for (size_t i = 0; i < m_raycastEntities.size(); ++i) {
+        raycasts.get<components::Raycast>(m_raycastEntities[i]).set_hit(m_raycastHits[i]);
+    }
+}
+
+void Physics::raycast_batch(const RaycastQuery* queries, QueryHit* hits, size_t count) {
+    PxScene* scene = m_Scene->get();
+    m_engine.get_job_system().lock()->parallel_for(
+        count, QUERY_GRAIN_SIZE, [scene, queries, hits](size_t begin, size_t end) {
+            PxQueryFilterData filterData(PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC | PxQueryFlag::ePREFILTER);
+            for (size_t i = begin; i < end; ++i) {
+                const RaycastQuery& query = queries[i];
+                hits[i] = QueryHit();
+                // the built in filter is skipped for all zero filter data, an empty mask would hit every layer
+                if (query.layerMask == 0) {
+                    continue;
+                }
+                filterData.data.word0 = query.layerMask;
+                PxRaycastBuffer buffer;
+                bool isHit = scene->raycast(components::RigidBody::vec3_to_PxVec3(query.origin),
+                                            components::RigidBody::vec3_to_PxVec3(query.unitDir), query.maxDistance,
+                                            buffer, PxHitFlag::eDEFAULT, filterData, &s_activeActorFilter);
+                if (isHit) {
+                    fill_hit(hits[i], buffer.block);
+                    hits[i].position = components::RigidBody::PxVec3_to_vec3(buffer.block.position);
+                    hits[i].normal = components::RigidBody::PxVec3_to_vec3(buffer.block.normal);
+                    hits[i].distance = buffer.block.distance;
+                }
+            }
+        });
+}
+
+void Physics::sweep_batch(const SweepQuery* queries, QueryHit* hits, size_t count) {
+    PxScene* scene = m_Scene->get();
+    m_engine.get_job_system().lock()->parallel_for(
+        count, QUERY_GRAIN_SIZE, [scene, queries, hits](size_t begin, size_t end) {
+            PxQueryFilterData filterData(PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC | PxQueryFlag::ePREFILTER);
+            for (size_t i = begin; i < end; ++i) {
+                const SweepQuery& query = queries[i];
+                hits[i] = QueryHit();
+                // the built in filter is skipped for all zero filter data, an empty mask would hit every layer
+                if (query.layerMask == 0) {
+                    continue;
+                }
+                filterData.data.word0 = query.layerMask;
+                PxSweepBuffer buffer;
+                bool isHit = scene->sweep(query.geometry.any(), query.pose,
+                                          components::RigidBody::vec3_to_PxVec3(query.unitDir), query.maxDistance,
+                                          buffer, PxHitFlag::eDEFAULT, filterData, &s_activeActorFilter);
+                if (isHit) {
+                    fill_hit(hits[i], buffer.block);
+                    hits[i].position = components::RigidBody::PxVec3_to_vec3(buffer.block.position);
+                    hits[i].normal = components::RigidBody::PxVec3_to_vec3(buffer.block.normal);
+                    hits[i].distance = buffer.block.distance;
+                }
+            }
+        });
+}
+
+void Physics::overlap_batch(const OverlapQuery* queries, QueryHit* hits, size_t count) {
+    PxScene* scene = m_Scene->get();
+    m_engine.get_job_system().lock()->parallel_for(
+        count, QUERY_GRAIN_SIZE, [scene, queries, hits](size_t begin, size_t end) {
+            // any hit is enough, overlaps have no ordering to find a closest one by
+            PxQueryFilterData filterData(PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC | PxQueryFlag::ePREFILTER |
+                                         PxQueryFlag::eANY_HIT);
+            for (size_t i = begin; i < end; ++i) {
+                const OverlapQuery& query = queries[i];
+                hits[i] = QueryHit();
+                // the built in filter is skipped for all zero filter data, an empty mask would hit every layer
+                if (query.layerMask == 0) {
+                    continue;
+                }
+                filterData.data.word0 = query.layerMask;
+                PxOverlapBuffer buffer;
+                bool isHit = scene->overlap(query.geometry.any(), query.pose, buffer, filterData, &s_activeActorFilter);
+                if (isHit) {
+                    fill_hit(hits[i], buffer.block);
+                }
+            }
+        });
+}
+
+void Physics::fill_hit(QueryHit& hit, const PxActorShape& block) {
+    hit.isHit = true;
+    hit.actor = block.actor;
+    hit.shape = block.shape;
+    hit.entity = block.actor ? get_actor_entity(*block.actor) : entt::null;
 }
 
 void Physics::set_gravity(PxVec3 gravity) {
@@ -0,0 +1,140 @@
+#include <knoting/engine.h>
+#include <knoting/physics_aggregate.h>
+#include <knoting/scene.h>
+
+#include <utility>
+
+namespace knot {
+namespace components {
+
+PhysicsAggregate::PhysicsAggregate(bool selfCollision) : m_selfCollision(selfCollision) {}
+
+PhysicsAggregate::PhysicsAggregate(PhysicsAggregate&& other) noexcept
+    : OwnedComponent(other),
+      m_aggregate(std::exchange(other.m_aggregate, nullptr)),
+      m_selfCollision(other.m_selfCollision) {}
+
+PhysicsAggregate& PhysicsAggregate::operator=(PhysicsAggregate&& other) noexcept {
+    if (this != &other) {
+        release_aggregate();
+        OwnedComponent::operator=(other);
+        m_aggregate = std::exchange(other.m_aggregate, nullptr);
+        m_selfCollision = other.m_selfCollision;
+    }
+    return *this;
+}
+
+void PhysicsAggregate::on_awake() {
+    rebuild();
+}
+
+void PhysicsAggregate::on_load() {
+    rebuild();
+}
+
+void PhysicsAggregate::on_destroy() {
+    release_aggregate();
+}
+
+void PhysicsAggregate::set_self_collision(bool selfCollision) {
+    if (m_selfCollision == selfCollision) {
+        return;
+    }
+    m_selfCollision = selfCollision;
+    // fixed at creation
+    if (m_aggregate) {
+        rebuild();
+    }
+}
+
+void PhysicsAggregate::rebuild() {
+    release_aggregate();
+
+    Physics* physics = Physics::get_instance();
+    if (!physics) {
+        return;
+    }
+
+    std::vector<PxRigidActor*> actors;
+    collect_actors(actors);
+    if (actors.empty()) {
+        return;
+    }
+    if (actors.size() > MAX_AGGREGATE_ACTORS) {
+        log::warn("physics aggregate holds at most {} actors, {} are left out", MAX_AGGREGATE_ACTORS,
+                  actors.size() - MAX_AGGREGATE_ACTORS);
+        actors.resize(MAX_AGGREGATE_ACTORS);
+    }
+
+    // actors can only move between the scene and the aggregate between steps
+    physics->end_simulation();
+    m_aggregate = Physics::get_px_physics()->createAggregate(static_cast<PxU32>(actors.size()), m_selfCollision);
+    for (PxRigidActor* actor : actors) {
+        if (PxScene* scene = actor->getScene()) {
+            scene->removeActor(*actor);
+        }
+        m_aggregate->addActor(*actor);
+    }
+    Physics::get_px_scene()->addAggregate(*m_aggregate);
+}
+
+void PhysicsAggregate::collect_actors(std::vector<PxRigidActor*>& actors) const {
+    auto sceneOpt = Scene::get_active_scene();
+    if (!sceneOpt || m_entity == entt::null) {
+        return;
+    }
+    Scene& scene = sceneOpt.value();
+    entt::registry& registry = scene.get_registry();
+
+    std::vector<entt::entity> open = {m_entity};
+    while (!open.empty()) {
+        entt::entity e = open.back();
+        open.pop_back();
+
+        if (RigidBody* rigidbody = registry.try_get<RigidBody>(e)) {
+            PxRigidActor* actor = rigidbody->get_actor();
+            if (actor && !actor->getAggregate()) {
+                actors.emplace_back(actor);
+            } else if (actor) {
+                log::warn("physics actor of entity {} already belongs to an aggregate", entt::to_integral(e));
+            }
+        }
+
+        if (Hierarchy* hierarchy = registry.try_get<Hierarchy>(e)) {
+            for (const uuid& childId : hierarchy->get_children()) {
+                if (auto childOpt = scene.get_game_object_from_id(childId)) {
+                    open.emplace_back(childOpt->get_handle());
+                }
+            }
+        }
+    }
+}
+
+void PhysicsAggregate::release_aggregate() {
+    if (!m_aggregate) {
+        return;
+    }
+    // the aggregate dies with its PxPhysics, once the physics module is gone there is nothing left to release
+    if (Physics* physics = Physics::get_instance()) {
+        physics->end_simulation();
+
+        // the actors stay in the scene as standalone actors
+        PxScene* scene = m_aggregate->getScene();
+        std::vector<PxActor*> actors(m_aggregate->getNbActors());
+        m_aggregate->getActors(actors.data(), static_cast<PxU32>(actors.size()));
+        for (PxActor* actor : actors) {
+            m_aggregate->removeActor(*actor);
+            if (scene && !actor->getScene()) {
+                scene->addActor(*actor);
+            }
+        }
+        if (scene) {
+            scene->removeAggregate(*m_aggregate);
+        }
+        m_aggregate->release();
+    }
+    m_aggregate = nullptr;
+}
+
+}  // namespace components
+}  // namespace knot
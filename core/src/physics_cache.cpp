@@ -0,0 +1,189 @@
+#include <knoting/log.h>
+#include <knoting/physics_cache.h>
+
+#include <cstring>
+
+namespace knot {
+
+namespace {
+
+// appends values to the key as raw 32 bit words
+class KeyWriter {
+   public:
+    explicit KeyWriter(PhysicsCacheKey& key) : m_key(key) { m_key.fill(0); }
+
+    void write(float value) {
+        uint32_t word;
+        std::memcpy(&word, &value, sizeof(word));
+        write(word);
+    }
+
+    void write(uint32_t value) {
+        if (m_size == m_key.size()) {
+            log::error("physics cache key overflow");
+            return;
+        }
+        m_key[m_size++] = value;
+    }
+
+    void write(const void* pointer) {
+        uint64_t value = reinterpret_cast<uintptr_t>(pointer);
+        write(static_cast<uint32_t>(value));
+        write(static_cast<uint32_t>(value >> 32));
+    }
+
+    void write(const PxVec3& v) {
+        write(v.x);
+        write(v.y);
+        write(v.z);
+    }
+
+    void write(const PxQuat& q) {
+        write(q.x);
+        write(q.y);
+        write(q.z);
+        write(q.w);
+    }
+
+   private:
+    PhysicsCacheKey& m_key;
+    size_t m_size = 0;
+};
+
+}  // namespace
+
+size_t PhysicsCacheKeyHash::operator()(const PhysicsCacheKey& key) const {
+    // FNV-1a over the words
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t word : key) {
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+PhysicsCache::PhysicsCache(std::shared_ptr<PxPhysics_ptr_wrapper> physics) : m_physics(physics) {}
+
+std::shared_ptr<PxMaterial_ptr_wrapper> PhysicsCache::acquire_material(float staticFriction,
+                                                                       float dynamicFriction,
+                                                                       float restitution) {
+    PhysicsCacheKey key;
+    KeyWriter writer(key);
+    writer.write(staticFriction);
+    writer.write(dynamicFriction);
+    writer.write(restitution);
+
+    auto it = m_materials.find(key);
+    if (it != m_materials.end()) {
+        if (auto material = it->second.lock()) {
+            return material;
+        }
+    }
+
+    auto material = std::make_shared<PxMaterial_ptr_wrapper>(
+        m_physics->get()->createMaterial(staticFriction, dynamicFriction, restitution));
+    m_materials[key] = material;
+    return material;
+}
+
+std::shared_ptr<PxShape_ptr_wrapper> PhysicsCache::acquire_shape(const PxGeometry& geometry,
+                                                                 PxMaterial& material,
+                                                                 const PxTransform& localPose,
+                                                                 CollisionLayer layer,
+                                                                 bool isTrigger) {
+    PhysicsCacheKey key = make_shape_key(geometry, material, localPose, layer, isTrigger);
+
+    auto it = m_shapes.find(key);
+    if (it != m_shapes.end()) {
+        if (auto shape = it->second.lock()) {
+            return shape;
+        }
+    }
+
+    PxShape* pxShape = m_physics->get()->createShape(geometry, material, false);
+    if (!pxShape) {
+        log::error("physics cache failed to create a shape");
+        return nullptr;
+    }
+    pxShape->setLocalPose(localPose);
+    pxShape->setSimulationFilterData(make_simulation_filter_data(layer));
+    pxShape->setQueryFilterData(make_query_filter_data(layer));
+    if (isTrigger) {
+        // a shape can not be a simulation and a trigger shape at once
+        pxShape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, false);
+        pxShape->setFlag(PxShapeFlag::eSCENE_QUERY_SHAPE, false);
+        pxShape->setFlag(PxShapeFlag::eTRIGGER_SHAPE, true);
+    }
+
+    auto shape = std::make_shared<PxShape_ptr_wrapper>(pxShape);
+    m_shapes[key] = shape;
+    return shape;
+}
+
+void PhysicsCache::collect_garbage() {
+    for (auto it = m_materials.begin(); it != m_materials.end();) {
+        it = it->second.expired() ? m_materials.erase(it) : std::next(it);
+    }
+    for (auto it = m_shapes.begin(); it != m_shapes.end();) {
+        it = it->second.expired() ? m_shapes.erase(it) : std::next(it);
+    }
+}
+
+PhysicsCacheKey PhysicsCache::make_shape_key(const PxGeometry& geometry,
+                                             const PxMaterial& material,
+                                             const PxTransform& localPose,
+                                             CollisionLayer layer,
+                                             bool isTrigger) {
+    PhysicsCacheKey key;
+    KeyWriter writer(key);
+    writer.write(static_cast<uint32_t>(geometry.getType()));
+
+    switch (geometry.getType()) {
+        case PxGeometryType::eBOX: {
+            writer.write(static_cast<const PxBoxGeometry&>(geometry).halfExtents);
+            break;
+        }
+        case PxGeometryType::eSPHERE: {
+            writer.write(static_cast<const PxSphereGeometry&>(geometry).radius);
+            break;
+        }
+        case PxGeometryType::eCAPSULE: {
+            const auto& capsule = static_cast<const PxCapsuleGeometry&>(geometry);
+            writer.write(capsule.radius);
+            writer.write(capsule.halfHeight);
+            break;
+        }
+        case PxGeometryType::eCONVEXMESH: {
+            const auto& convex = static_cast<const PxConvexMeshGeometry&>(geometry);
+            writer.write(convex.convexMesh);
+            writer.write(convex.scale.scale);
+            writer.write(convex.scale.rotation);
+            break;
+        }
+        case PxGeometryType::eTRIANGLEMESH: {
+            const auto& triangles = static_cast<const PxTriangleMeshGeometry&>(geometry);
+            writer.write(triangles.triangleMesh);
+            writer.write(triangles.scale.scale);
+            writer.write(triangles.scale.rotation);
+            break;
+        }
+        case PxGeometryType::eHEIGHTFIELD: {
+            const auto& heightField = static_cast<const PxHeightFieldGeometry&>(geometry);
+            writer.write(heightField.heightField);
+            writer.write(heightField.heightScale);
+            writer.write(heightField.rowScale);
+            writer.write(heightField.columnScale);
+            break;
+        }
+        default:
+            break;
+    }
+
+    writer.write(&material);
+    writer.write(localPose.p);
+    writer.write(localPose.q);
+    writer.write(static_cast<uint32_t>(layer) | (isTrigger ? 0x100u : 0u));
+    return key;
+}
+
+}  // namespace knot
@@ -0,0 +1,153 @@
+#include <knoting/physics.h>
+#include <knoting/physics_events.h>
+
+namespace knot {
+
+// contact points read per pair, enough for the average and the summed impulse of the pair
+constexpr PxU32 MAX_PAIR_POINTS = 16;
+
+PhysicsEventBuffer::PhysicsEventBuffer(size_t capacity) : m_events(capacity) {}
+
+void PhysicsEventBuffer::onContact(const PxContactPairHeader& pairHeader, const PxContactPair* pairs, PxU32 nbPairs) {
+    const bool actorRemoved0 = pairHeader.flags & PxContactPairHeaderFlag::eREMOVED_ACTOR_0;
+    const bool actorRemoved1 = pairHeader.flags & PxContactPairHeaderFlag::eREMOVED_ACTOR_1;
+
+    PxContactPairPoint points[MAX_PAIR_POINTS];
+    for (PxU32 i = 0; i < nbPairs; ++i) {
+        const PxContactPair& pair = pairs[i];
+        const bool found = pair.events & PxPairFlag::eNOTIFY_TOUCH_FOUND;
+        const bool lost = pair.events & PxPairFlag::eNOTIFY_TOUCH_LOST;
+        if (!found && !lost) {
+            continue;
+        }
+
+        entt::entity entityA, entityB;
+        CollisionLayer layerA, layerB;
+        if (!resolve(pairHeader.actors[0], pair.shapes[0], actorRemoved0,
+                     pair.flags & PxContactPairFlag::eREMOVED_SHAPE_0, entityA, layerA) ||
+            !resolve(pairHeader.actors[1], pair.shapes[1], actorRemoved1,
+                     pair.flags & PxContactPairFlag::eREMOVED_SHAPE_1, entityB, layerB)) {
+            continue;
+        }
+
+        // a pair can touch and separate within one step, it gets both events in that order
+        if (found) {
+            PhysicsEvent* event = push();
+            if (event) {
+                event->type = PhysicsEventType::ContactBegin;
+                event->entityA = entityA;
+                event->entityB = entityB;
+                event->layerA = layerA;
+                event->layerB = layerB;
+                event->point = vec3(0.0f);
+                event->impulse = vec3(0.0f);
+
+                PxU32 count = pair.extractContacts(points, MAX_PAIR_POINTS);
+                if (count > 0) {
+                    PxVec3 point(0.0f);
+                    PxVec3 impulse(0.0f);
+                    for (PxU32 p = 0; p < count; ++p) {
+                        point += points[p].position;
+                        impulse += points[p].impulse;
+                    }
+                    point /= static_cast<PxReal>(count);
+                    event->point = vec3(point.x, point.y, point.z);
+                    event->impulse = vec3(impulse.x, impulse.y, impulse.z);
+                }
+            }
+        }
+        if (lost) {
+            PhysicsEvent* event = push();
+            if (event) {
+                event->type = PhysicsEventType::ContactEnd;
+                event->entityA = entityA;
+                event->entityB = entityB;
+                event->layerA = layerA;
+                event->layerB = layerB;
+                event->point = vec3(0.0f);
+                event->impulse = vec3(0.0f);
+            }
+        }
+    }
+}
+
+void PhysicsEventBuffer::onTrigger(PxTriggerPair* pairs, PxU32 count) {
+    for (PxU32 i = 0; i < count; ++i) {
+        const PxTriggerPair& pair = pairs[i];
+        // removed shapes also mean their actor may be gone, both sides go through the noted removals then
+        const bool triggerRemoved = pair.flags & PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER;
+        const bool otherRemoved = pair.flags & PxTriggerPairFlag::eREMOVED_SHAPE_OTHER;
+
+        entt::entity entityA, entityB;
+        CollisionLayer layerA, layerB;
+        if (!resolve(pair.triggerActor, pair.triggerShape, triggerRemoved, triggerRemoved, entityA, layerA) ||
+            !resolve(pair.otherActor, pair.otherShape, otherRemoved, otherRemoved, entityB, layerB)) {
+            continue;
+        }
+
+        PhysicsEvent* event = push();
+        if (!event) {
+            continue;
+        }
+        event->type = pair.status == PxPairFlag::eNOTIFY_TOUCH_FOUND ? PhysicsEventType::TriggerEnter
+                                                                      : PhysicsEventType::TriggerExit;
+        event->entityA = entityA;
+        event->entityB = entityB;
+        event->layerA = layerA;
+        event->layerB = layerB;
+        event->point = vec3(0.0f);
+        event->impulse = vec3(0.0f);
+    }
+}
+
+void PhysicsEventBuffer::note_removed_actor(const PxActor* actor, entt::entity entity, CollisionLayer layer) {
+    m_removedActors.emplace_back(RemovedActor{actor, entity, layer});
+}
+
+bool PhysicsEventBuffer::resolve(const PxActor* actor,
+                                 const PxShape* shape,
+                                 bool actorRemoved,
+                                 bool shapeRemoved,
+                                 entt::entity& entity,
+                                 CollisionLayer& layer) const {
+    if (!actorRemoved && !shapeRemoved) {
+        entity = Physics::get_actor_entity(*actor);
+        layer = static_cast<CollisionLayer>(shape->getSimulationFilterData().word0);
+        return true;
+    }
+    // pointers are only compared, never read
+    for (const RemovedActor& removed : m_removedActors) {
+        if (removed.actor == actor) {
+            entity = removed.entity;
+            layer = removed.layer;
+            return true;
+        }
+    }
+    if (actorRemoved) {
+        return false;
+    }
+    // a shape swapped off a living actor, its layer is the one the actor carries now
+    entity = Physics::get_actor_entity(*actor);
+    PxShape* current = nullptr;
+    const PxRigidActor* rigidActor = actor->is<PxRigidActor>();
+    if (!rigidActor || rigidActor->getShapes(&current, 1) == 0) {
+        return false;
+    }
+    layer = static_cast<CollisionLayer>(current->getSimulationFilterData().word0);
+    return true;
+}
+
+void PhysicsEventBuffer::clear() {
+    m_count = 0;
+    m_dropped = 0;
+}
+
+PhysicsEvent* PhysicsEventBuffer::push() {
+    if (m_count == m_events.size()) {
+        m_dropped++;
+        return nullptr;
+    }
+    return &m_events[m_count++];
+}
+
+}  // namespace knot
@@ -0,0 +1,177 @@
+#include <knoting/components.h>
+#include <knoting/physics_snapshot.h>
+
+#include <algorithm>
+
+namespace knot {
+
+void PhysicsSnapshot::capture_bodies(entt::registry& registry) {
+    using namespace components;
+    bodies.clear();
+
+    for (auto [e, rigidbody] : registry.view<RigidBody>().each()) {
+        PxRigidDynamic* dynamic = rigidbody.get_dynamic();
+        if (!dynamic) {
+            continue;
+        }
+
+        PhysicsBodyState& state = bodies.emplace_back();
+        state.entity = e;
+        state.actor = dynamic;
+        state.pose = dynamic->getGlobalPose();
+
+        if (dynamic->getRigidBodyFlags().isSet(PxRigidBodyFlag::eKINEMATIC)) {
+            state.flags |= BODY_KINEMATIC;
+        } else if (dynamic->getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION)) {
+            state.flags |= BODY_SIMULATION_DISABLED;
+        } else {
+            state.linearVelocity = dynamic->getLinearVelocity();
+            state.angularVelocity = dynamic->getAngularVelocity();
+            if (dynamic->isSleeping()) {
+                state.flags |= BODY_SLEEPING;
+            }
+        }
+
+        if (const PhysicsLodParked* parked = registry.try_get<PhysicsLodParked>(e)) {
+            state.flags |= BODY_LOD_PARKED;
+            state.lodLinearVelocity = parked->linearVelocity;
+            state.lodAngularVelocity = parked->angularVelocity;
+        }
+    }
+}
+
+size_t PhysicsSnapshot::restore_bodies(entt::registry& registry) const {
+    using namespace components;
+    size_t restored = 0;
+
+    for (const PhysicsBodyState& state : bodies) {
+        if (!registry.valid(state.entity)) {
+            continue;
+        }
+        RigidBody* rigidbody = registry.try_get<RigidBody>(state.entity);
+        PxRigidDynamic* dynamic = rigidbody ? rigidbody->get_dynamic() : nullptr;
+        if (!dynamic || dynamic != state.actor) {
+            continue;
+        }
+
+        // velocities only stick while the body simulates, so the flag is settled first
+        const bool wasDisabled = state.flags & BODY_SIMULATION_DISABLED;
+        if (dynamic->getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION) != wasDisabled) {
+            rigidbody->set_simulation_enabled(!wasDisabled);
+        }
+
+        dynamic->setGlobalPose(state.pose, false);
+        if (!(state.flags & (BODY_KINEMATIC | BODY_SIMULATION_DISABLED))) {
+            dynamic->setLinearVelocity(state.linearVelocity, false);
+            dynamic->setAngularVelocity(state.angularVelocity, false);
+            if (state.flags & BODY_SLEEPING) {
+                dynamic->putToSleep();
+            } else {
+                dynamic->wakeUp();
+            }
+        }
+
+        if (state.flags & BODY_LOD_PARKED) {
+            registry.emplace_or_replace<PhysicsLodParked>(state.entity, state.lodLinearVelocity,
+                                                          state.lodAngularVelocity, wasDisabled);
+        } else {
+            registry.remove<PhysicsLodParked>(state.entity);
+        }
+
+        // no blend across a rewind, both poses of the history start at the restored one
+        rigidbody->reset_pose_history();
+        if (Transform* transform = registry.try_get<Transform>(state.entity)) {
+            transform->set_position(RigidBody::PxVec3_to_vec3(state.pose.p));
+            transform->set_rotation(RigidBody::PxQuat_to_quat(state.pose.q));
+        }
+        ++restored;
+    }
+    return restored;
+}
+
+void PhysicsSnapshot::capture_controllers(entt::registry& registry) {
+    using namespace components;
+    controllers.clear();
+
+    for (auto [e, controller] : registry.view<CharacterController>().each()) {
+        const PxController* pxController = controller.get_controller();
+        if (!pxController) {
+            continue;
+        }
+        PhysicsControllerState& state = controllers.emplace_back();
+        state.entity = e;
+        state.controller = pxController;
+        state.footPosition = pxController->getFootPosition();
+        state.verticalSpeed = controller.get_vertical_speed();
+    }
+}
+
+size_t PhysicsSnapshot::restore_controllers(entt::registry& registry) const {
+    using namespace components;
+    size_t restored = 0;
+
+    for (const PhysicsControllerState& state : controllers) {
+        if (!registry.valid(state.entity)) {
+            continue;
+        }
+        CharacterController* controller = registry.try_get<CharacterController>(state.entity);
+        if (!controller || controller->get_controller() != state.controller) {
+            continue;
+        }
+        const PxExtendedVec3& foot = state.footPosition;
+        // also resets the interpolation and writes the transform
+        controller->restore_state(
+            vec3(static_cast<float>(foot.x), static_cast<float>(foot.y), static_cast<float>(foot.z)),
+            state.verticalSpeed);
+        ++restored;
+    }
+    return restored;
+}
+
+PhysicsSnapshotRing::PhysicsSnapshotRing(size_t frameCount, size_t bodyCapacity)
+    : m_frames(std::max<size_t>(frameCount, 1)) {
+    for (auto& frame : m_frames) {
+        frame.bodies.reserve(bodyCapacity);
+    }
+}
+
+PhysicsSnapshot& PhysicsSnapshotRing::push(uint64_t step) {
+    m_head = (m_head + 1) % m_frames.size();
+    m_size = std::min(m_size + 1, m_frames.size());
+
+    PhysicsSnapshot& snapshot = m_frames[m_head];
+    snapshot.step = step;
+    snapshot.accumulator = 0.0;
+    snapshot.bodies.clear();
+    snapshot.controllers.clear();
+    snapshot.collection.clear();
+    return snapshot;
+}
+
+const PhysicsSnapshot* PhysicsSnapshotRing::find(uint64_t step) const {
+    // newest first, rewinds usually go back a few steps
+    for (size_t i = 0; i < m_size; ++i) {
+        const PhysicsSnapshot& snapshot = m_frames[(m_head + m_frames.size() - i) % m_frames.size()];
+        if (snapshot.step == step) {
+            return &snapshot;
+        }
+    }
+    return nullptr;
+}
+
+const PhysicsSnapshot* PhysicsSnapshotRing::latest() const {
+    return m_size > 0 ? &m_frames[m_head] : nullptr;
+}
+
+void PhysicsSnapshotRing::truncate_after(uint64_t step) {
+    while (m_size > 0 && m_frames[m_head].step > step) {
+        m_head = (m_head + m_frames.size() - 1) % m_frames.size();
+        --m_size;
+    }
+}
+
+void PhysicsSnapshotRing::clear() {
+    m_size = 0;
+}
+
+}  // namespace knot
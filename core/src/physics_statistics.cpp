@@ -0,0 +1,32 @@
+#include <knoting/physics_statistics.h>
+
+namespace knot {
+
+bool PhysicsStepTimer::start(PxTaskManager& taskManager) {
+    if (is_running()) {
+        return false;
+    }
+    // one reference held here, simulate adds its own and drops it once the step completes
+    setContinuation(taskManager, nullptr);
+    m_finished.store(false, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+    m_start = std::chrono::high_resolution_clock::now();
+    return true;
+}
+
+double PhysicsStepTimer::get_step_ms() const {
+    auto stop = m_finished.load(std::memory_order_acquire) ? m_finish : std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - m_start).count();
+}
+
+void PhysicsStepTimer::run() {
+    m_finish = std::chrono::high_resolution_clock::now();
+    m_finished.store(true, std::memory_order_release);
+}
+
+void PhysicsStepTimer::release() {
+    PxLightCpuTask::release();
+    m_running.store(false, std::memory_order_release);
+}
+
+}  // namespace knot
@@ -0,0 +1,45 @@
+#include <knoting/log.h>
+#include <knoting/px_job_dispatcher.h>
+
+#include <algorithm>
+
+namespace knot {
+
+PxJobDispatcher::PxJobDispatcher(JobSystem& jobSystem, uint32_t workerCount)
+    : m_jobSystem(jobSystem), m_workerCount(workerCount) {
+    if (m_workerCount == 0 || m_workerCount > m_jobSystem.get_worker_count()) {
+        m_workerCount = m_jobSystem.get_worker_count();
+    }
+    log::debug("physics dispatching onto {} job workers", m_workerCount);
+}
+
+void PxJobDispatcher::submitTask(PxBaseTask& task) {
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        if (m_inFlight >= m_workerCount) {
+            m_pending.emplace_back(&task);
+            return;
+        }
+        ++m_inFlight;
+    }
+    m_jobSystem.submit([this, first = &task]() { run_tasks(first); });
+}
+
+void PxJobDispatcher::run_tasks(PxBaseTask* task) {
+    // keeps its slot and drains the backlog, so the number of busy workers never exceeds the cap
+    while (task) {
+        task->run();
+        task->release();
+
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        if (m_pending.empty()) {
+            --m_inFlight;
+            task = nullptr;
+        } else {
+            task = m_pending.front();
+            m_pending.pop_front();
+        }
+    }
+}
+
+}  // namespace knot
@@ -1,28 +1,43 @@
 #include <knoting/engine.h>
 #include <knoting/raycast.h>
 #include <knoting/rigidbody.h>
+#include <knoting/serialization.h>
 #include <cereal/archives/json.hpp>
 
 namespace knot {
 namespace components {
-Raycast::Raycast() : m_scene(nullptr) {}
+
+Raycast::Raycast() {}
 
 Raycast::~Raycast() {}
 
 void Raycast::on_awake() {
-    auto engineOpt = Engine::get_active_engine();
-    if (engineOpt) {
-        Engine& engine = engineOpt.value();
-        m_scene = engine.get_physics_module().lock()->get_active_Scene().lock();
-    }
-    m_isHit = false;
+    m_hit = QueryHit();
     m_origin = get_position_from_transform();
 }
 
 void Raycast::on_destroy() {}
 
 void Raycast::raycast() {
-    m_scene->get()->raycast(m_origin, m_unitDir, m_maxDistance, m_hit);
+    auto engineOpt = Engine::get_active_engine();
+    if (!engineOpt) {
+        return;
+    }
+    RaycastQuery query = get_query();
+    engineOpt->get().get_physics_module().lock()->raycast_batch(&query, &m_hit, 1);
+}
+
+RaycastQuery Raycast::get_query() const {
+    RaycastQuery query;
+    query.origin = RigidBody::PxVec3_to_vec3(m_origin);
+    query.unitDir = RigidBody::PxVec3_to_vec3(m_unitDir);
+    query.maxDistance = m_maxDistance;
+    query.layerMask = m_layerMask;
+    return query;
+}
+
+void Raycast::set_hit(const QueryHit& hit) {
+    m_hit = hit;
 }
 
 vec3 Raycast::get_origin() {
@@ -34,31 +49,19 @@ vec3 Raycast::get_unitDir() {
 }
 
 vec3 Raycast::get_hit_position() {
-    if (m_isHit) {
-        return RigidBody::PxVec3_to_vec3(m_hit.block.position);
-    }
-    return vec3(std::numeric_limits<float>::max());
+    return m_hit.position;
 }
 
 vec3 Raycast::get_hit_normal() {
-    if (m_isHit) {
-        return RigidBody::PxVec3_to_vec3(m_hit.block.normal);
-    }
-    return vec3(std::numeric_limits<float>::max());
+    return m_hit.normal;
 }
 
 float Raycast::get_hit_distance() {
-    if (m_isHit) {
-        return m_hit.block.distance;
-    }
-    return std::numeric_limits<float>::max();
+    return m_hit.distance;
 }
 
-std::weak_ptr<PxShape_ptr_wrapper> Raycast::get_hit_shape() {
-    if (m_isHit) {
-        return std::make_shared<PxShape_ptr_wrapper>(m_hit.block.shape);
-    }
-    return std::make_shared<PxShape_ptr_wrapper>();
+PxShape* Raycast::get_hit_shape() {
+    return m_hit.shape;
 }
 
 void Raycast::set_origin(const vec3& origin) {
@@ -79,17 +82,8 @@ void Raycast::set_raycast(const vec3& origin, const vec3& unitDir, const float&
 }
 
 PxVec3 Raycast::get_position_from_transform() {
-    auto sceneOpt = Scene::get_active_scene();
-    if (sceneOpt) {
-        Scene& scene = sceneOpt.value();
-        entt::entity handle = entt::to_entity(scene.get_registry(), *this);
-        auto goOpt = scene.get_game_object_from_handle(handle);
-        ;
-        if (goOpt) {
-            PxVec3 position = RigidBody::vec3_to_PxVec3(goOpt->get_component<components::Transform>().get_position());
-
-            return position;
-        }
+    if (Transform* transform = get_sibling<Transform>()) {
+        return RigidBody::vec3_to_PxVec3(transform->get_position());
     }
     return PxVec3(std::numeric_limits<float>::max());
 }
@@ -97,7 +91,7 @@ PxVec3 Raycast::get_position_from_transform() {
 template <class Archive>
 void Raycast::save(Archive& archive) const {
     archive(CEREAL_NVP(RigidBody::PxVec3_to_vec3(m_origin)), CEREAL_NVP(RigidBody::PxVec3_to_vec3(m_unitDir)),
-            CEREAL_NVP((float)m_maxDistance));
+            CEREAL_NVP((float)m_maxDistance), cereal::make_nvp("layerMask", m_layerMask));
 }
 
 template <class Archive>
@@ -105,10 +99,14 @@ void Raycast::load(Archive& archive) {
     vec3 origin, unitDir;
     float maxDistance;
     archive(CEREAL_NVP(origin), CEREAL_NVP(unitDir), CEREAL_NVP(maxDistance));
+    // scenes saved before collision layers hit everything
+    m_layerMask = ALL_COLLISION_LAYERS;
+    load_optional_nvp(archive, "layerMask", m_layerMask);
     m_origin = RigidBody::vec3_to_PxVec3(origin);
     m_unitDir = RigidBody::vec3_to_PxVec3(unitDir);
     m_maxDistance = maxDistance;
-    on_awake();
+    // loaded into a temporary before the registry owns it, the saved origin is kept
+    m_hit = QueryHit();
 }
 
 template void Raycast::save<cereal::JSONOutputArchive>(cereal::JSONOutputArchive&) const;
@@ -4,34 +4,23 @@
 
 namespace knot {
 namespace components {
-RigidController::RigidController() : m_dynamic(nullptr) {}
-RigidController::~RigidController() {}
+RigidController::RigidController() {}
 
 void RigidController::on_awake() {
-    auto sceneOpt = Scene::get_active_scene();
-    if (sceneOpt) {
-        Scene& scene = sceneOpt.value();
-        entt::entity handle = entt::to_entity(scene.get_registry(), *this);
-        auto goOpt = scene.get_game_object_from_handle(handle);
-        if (goOpt) {
-            if (goOpt->has_component<components::RigidBody>()) {
-                RigidBody& rb = goOpt->get_component<components::RigidBody>();
-                m_dynamic = rb.get_dynamic().lock();
-            }
-        }
-    }
     m_isKinematic = false;
     m_isAwake = true;
 }
 
 void RigidController::on_destroy() {}
 
-std::weak_ptr<PxDynamic_ptr_wrapper> RigidController::get_dynamic() {
-    return m_dynamic;
+PxRigidDynamic* RigidController::get_dynamic() const {
+    RigidBody* rigidbody = get_sibling<RigidBody>();
+    return rigidbody ? rigidbody->get_dynamic() : nullptr;
 }
 
 float RigidController::get_mass() {
-    return m_dynamic->get()->getMass();
+    PxRigidDynamic* dynamic = get_dynamic();
+    return dynamic ? dynamic->getMass() : 0.0f;
 }
 
 bool RigidController::get_is_kinematic() {
@@ -43,72 +32,96 @@ bool RigidController::get_is_awake() {
 }
 
 float RigidController::get_linear_damping() {
-    return m_dynamic->get()->getLinearDamping();
+    PxRigidDynamic* dynamic = get_dynamic();
+    return dynamic ? dynamic->getLinearDamping() : 0.0f;
 }
 
 float RigidController::get_angular_damping() {
-    return m_dynamic->get()->getAngularDamping();
+    PxRigidDynamic* dynamic = get_dynamic();
+    return dynamic ? dynamic->getAngularDamping() : 0.0f;
 }
 
 vec3 RigidController::get_linear_velocity() {
-    return RigidBody::PxVec3_to_vec3(m_dynamic->get()->getLinearVelocity());
+    PxRigidDynamic* dynamic = get_dynamic();
+    return dynamic ? RigidBody::PxVec3_to_vec3(dynamic->getLinearVelocity()) : vec3(0.0f);
 }
 
 vec3 RigidController::get_angular_velocity() {
-    return RigidBody::PxVec3_to_vec3(m_dynamic->get()->getAngularVelocity());
-}
-
-void RigidController::set_dynamic(std::shared_ptr<PxDynamic_ptr_wrapper> dynamic) {
-    m_dynamic = dynamic;
+    PxRigidDynamic* dynamic = get_dynamic();
+    return dynamic ? RigidBody::PxVec3_to_vec3(dynamic->getAngularVelocity()) : vec3(0.0f);
 }
 
 void RigidController::set_kinematic(const bool& isKinematic) {
     m_isKinematic = isKinematic;
-    m_dynamic->get()->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, m_isKinematic);
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, m_isKinematic);
+    }
 }
 
 void RigidController::set_mass(const float& mass) {
-    m_dynamic->get()->setMass(mass);
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->setMass(mass);
+    }
 }
 
 void RigidController::set_angular_damping(const float& angDamp) {
-    m_dynamic->get()->setAngularDamping(angDamp);
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->setAngularDamping(angDamp);
+    }
 }
 
 void RigidController::set_linear_damping(const float& linDamp) {
-    m_dynamic->get()->setLinearDamping(linDamp);
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->setLinearDamping(linDamp);
+    }
 }
 
 void RigidController::set_angular_velocity(const vec3& angVel) {
-    m_dynamic->get()->setAngularVelocity(RigidBody::vec3_to_PxVec3(angVel));
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->setAngularVelocity(RigidBody::vec3_to_PxVec3(angVel));
+    }
 }
 
 void RigidController::set_linear_velocity(const vec3& linVel) {
-    m_dynamic->get()->setLinearVelocity(RigidBody::vec3_to_PxVec3(linVel));
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->setLinearVelocity(RigidBody::vec3_to_PxVec3(linVel));
+    }
 }
 
 void RigidController::add_force(const vec3& force) {
-    m_dynamic->get()->addForce(RigidBody::vec3_to_PxVec3(force));
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->addForce(RigidBody::vec3_to_PxVec3(force));
+    }
 }
 
 void RigidController::add_torque(const vec3& torque) {
-    m_dynamic->get()->addTorque(RigidBody::vec3_to_PxVec3(torque));
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->addTorque(RigidBody::vec3_to_PxVec3(torque));
+    }
 }
 
 void RigidController::clear_force() {
-    m_dynamic->get()->clearForce();
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->clearForce();
+    }
 }
 
 void RigidController::clear_torque() {
-    m_dynamic->get()->clearTorque();
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->clearTorque();
+    }
 }
 
 void RigidController::put_to_sleep() {
-    m_dynamic->get()->putToSleep();
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->putToSleep();
+    }
 }
 
 void RigidController::wakeUp() {
-    m_dynamic->get()->wakeUp();
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        dynamic->wakeUp();
+    }
 }
 void RigidController::on_load() {
     bool isAwake = m_isAwake;
@@ -2,143 +2,229 @@
 #include <knoting/rigidbody.h>
 #include <knoting/scene.h>
 
+#include <utility>
+
 namespace knot {
 namespace components {
-RigidBody::RigidBody()
-    : m_physics(nullptr), m_dynamic(nullptr), m_static(nullptr), m_scene(nullptr), m_shape(nullptr) {}
-
-RigidBody::~RigidBody() {}
 
-void RigidBody::on_awake() {
-    auto engineOpt = Engine::get_active_engine();
-    if (engineOpt) {
-        Engine& engine = engineOpt.value();
-        this->m_physics = engine.get_physics_module().lock()->get_physics().lock();
-        this->m_scene = engine.get_physics_module().lock()->get_active_Scene().lock();
-    }
-    if (get_shape_from_shape()) {
-        this->m_shape = get_shape_from_shape();
+RigidBody::RigidBody() {}
+
+RigidBody::RigidBody(RigidBody&& other) noexcept
+    : OwnedComponent(other),
+      m_actor(std::exchange(other.m_actor, nullptr)),
+      m_previousPose(other.m_previousPose),
+      m_currentPose(other.m_currentPose),
+      m_mass(other.m_mass),
+      m_type(other.m_type) {}
+
+RigidBody& RigidBody::operator=(RigidBody&& other) noexcept {
+    if (this != &other) {
+        // a replaced component gives its own actor up first
+        on_destroy();
+        OwnedComponent::operator=(other);
+        m_actor = std::exchange(other.m_actor, nullptr);
+        m_previousPose = other.m_previousPose;
+        m_currentPose = other.m_currentPose;
+        m_mass = other.m_mass;
+        m_type = other.m_type;
     }
+    return *this;
 }
-void RigidBody::on_destroy() {
-    if (m_dynamic) {
-        m_scene->get()->removeActor(*m_dynamic->get());
 
-    } else if (m_static) {
-        m_scene->get()->removeActor(*m_static->get());
+void RigidBody::on_destroy() {
+    if (!m_actor) {
+        return;
+    }
+    // actors die with their PxPhysics, once the physics module is gone there is nothing left to release
+    if (Physics* physics = Physics::get_instance()) {
+        // actors can not leave the scene mid step
+        physics->end_simulation();
+        if (PxScene* scene = m_actor->getScene()) {
+            physics->note_removed_actor(*m_actor);
+            scene->removeActor(*m_actor);
+        }
+        m_actor->release();
     }
+    m_actor = nullptr;
 }
 
 vec3 RigidBody::get_position() {
-    if (m_dynamic) {
-        return PxVec3_to_vec3(m_dynamic->get()->getGlobalPose().p);
-
-    } else {
-        return PxVec3_to_vec3(m_static->get()->getGlobalPose().p);
+    if (m_actor) {
+        return PxVec3_to_vec3(m_actor->getGlobalPose().p);
     }
     return vec3(0.0f);
 }
 
 quat RigidBody::get_rotation() {
-    if (m_dynamic) {
-        return PxQuat_to_quat(m_dynamic->get()->getGlobalPose().q);
-    } else {
-        return PxQuat_to_quat(m_static->get()->getGlobalPose().q);
+    if (m_actor) {
+        return PxQuat_to_quat(m_actor->getGlobalPose().q);
     }
     return quat();
 }
 
-std::weak_ptr<PxDynamic_ptr_wrapper> RigidBody::get_dynamic() {
-    return m_dynamic;
+PxRigidDynamic* RigidBody::get_dynamic() const {
+    return m_type == RigidBodyType::Dynamic ? static_cast<PxRigidDynamic*>(m_actor) : nullptr;
 }
 
-std::weak_ptr<PxStatic_ptr_wrapper> RigidBody::get_static() {
-    return m_static;
+PxRigidStatic* RigidBody::get_static() const {
+    return m_type == RigidBodyType::Static ? static_cast<PxRigidStatic*>(m_actor) : nullptr;
 }
 
 void RigidBody::set_transform(const vec3& position, const quat& rotation) {
-    if (m_dynamic == nullptr && m_static == nullptr) {
+    if (!m_actor) {
         return;
     }
-    if (m_dynamic) {
-        m_dynamic->get()->setGlobalPose(PxTransform(vec3_to_PxVec3(position)));
-        m_dynamic->get()->setGlobalPose(PxTransform(quat_to_PxQuat(rotation)));
-    } else {
-        m_static->get()->setGlobalPose(PxTransform(vec3_to_PxVec3(position)));
-        m_static->get()->setGlobalPose(PxTransform(quat_to_PxQuat(rotation)));
-    }
+    m_actor->setGlobalPose(PxTransform(vec3_to_PxVec3(position), quat_to_PxQuat(rotation)));
+    reset_pose_history();
+    sync_transform();
 }
 
 void RigidBody::set_position(const vec3& position) {
-    if (m_dynamic) {
-        m_dynamic->get()->setGlobalPose(PxTransform(vec3_to_PxVec3(position)));
-    } else {
-        m_static->get()->setGlobalPose(PxTransform(vec3_to_PxVec3(position)));
+    if (!m_actor) {
+        return;
     }
+    // only the position changes, the rotation stays
+    PxTransform pose = m_actor->getGlobalPose();
+    pose.p = vec3_to_PxVec3(position);
+    m_actor->setGlobalPose(pose);
+    reset_pose_history();
+    sync_transform();
 }
+
 void RigidBody::set_rotation(const quat& rotation) {
-    if (m_dynamic) {
-        m_dynamic->get()->setGlobalPose(PxTransform(quat_to_PxQuat(rotation)));
-    } else {
-        m_static->get()->setGlobalPose(PxTransform(quat_to_PxQuat(rotation)));
+    if (!m_actor) {
+        return;
+    }
+    PxTransform pose = m_actor->getGlobalPose();
+    pose.q = quat_to_PxQuat(rotation);
+    m_actor->setGlobalPose(pose);
+    reset_pose_history();
+    sync_transform();
+}
+
+void RigidBody::sync_transform() {
+    Transform* transform = get_sibling<Transform>();
+    if (!transform) {
+        return;
+    }
+    const PxTransform pose = m_actor->getGlobalPose();
+    transform->set_position(PxVec3_to_vec3(pose.p));
+    transform->set_rotation(PxQuat_to_quat(pose.q));
+}
+
+void RigidBody::record_pose() {
+    if (m_type != RigidBodyType::Dynamic || !m_actor) {
+        return;
+    }
+    m_previousPose = m_currentPose;
+    m_currentPose = m_actor->getGlobalPose();
+}
+
+void RigidBody::reset_pose_history() {
+    if (m_actor) {
+        m_currentPose = m_actor->getGlobalPose();
+    }
+    m_previousPose = m_currentPose;
+}
+
+vec3 RigidBody::get_interpolated_position(float alpha) const {
+    return PxVec3_to_vec3(m_previousPose.p * (1.0f - alpha) + m_currentPose.p * alpha);
+}
+
+quat RigidBody::get_interpolated_rotation(float alpha) const {
+    return glm::slerp(PxQuat_to_quat(m_previousPose.q), PxQuat_to_quat(m_currentPose.q), alpha);
+}
+
+void RigidBody::set_simulation_enabled(bool enabled) {
+    if (!m_actor) {
+        return;
+    }
+
+    PxRigidDynamic* dynamic = get_dynamic();
+    bool isKinematic = dynamic && dynamic->getRigidBodyFlags().isSet(PxRigidBodyFlag::eKINEMATIC);
+
+    if (!enabled && dynamic && !isKinematic) {
+        // velocities can not be changed once simulation is disabled, so drop them before parking
+        dynamic->setLinearVelocity(PxVec3(0.0f));
+        dynamic->setAngularVelocity(PxVec3(0.0f));
+    }
+
+    m_actor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, !enabled);
+
+    if (enabled && dynamic && !isKinematic) {
+        dynamic->wakeUp();
     }
 }
 
 void RigidBody::create_actor(bool isDynamic, const float& mass) {
+    build_actor(isDynamic, mass);
+    if (m_actor) {
+        Physics::get_px_scene()->addActor(*m_actor);
+    }
+}
+
+void RigidBody::build_actor(bool isDynamic, const float& mass) {
+    PxPhysics* physics = Physics::get_px_physics();
+    PxShape* shape = get_shape_from_shape();
+    if (!physics || !shape) {
+        log::warn("rigidbody needs an awake physics module and a Shape before building its actor");
+        return;
+    }
+
+    m_type = isDynamic ? RigidBodyType::Dynamic : RigidBodyType::Static;
+    m_mass = mass;
     if (isDynamic) {
-        m_dynamic = std::make_shared<PxDynamic_ptr_wrapper>(
-            m_physics->get()->createRigidDynamic(PxTransform(get_position_from_transform())));
-        m_dynamic->get()->attachShape(*m_shape->get());
-        PxRigidBodyExt::updateMassAndInertia(*m_dynamic->get(), mass);
-        m_scene->get()->addActor(*m_dynamic->get());
+        PxRigidDynamic* dynamic = physics->createRigidDynamic(PxTransform(get_position_from_transform()));
+        dynamic->attachShape(*shape);
+        PxRigidBodyExt::updateMassAndInertia(*dynamic, mass);
+        m_actor = dynamic;
     } else {
-        m_static = std::make_shared<PxStatic_ptr_wrapper>(
-            m_physics->get()->createRigidStatic(PxTransform(get_position_from_transform())));
-        m_static->get()->attachShape(*m_shape->get());
-        m_scene->get()->addActor(*m_static->get());
+        m_actor = physics->createRigidStatic(PxTransform(get_position_from_transform()));
+        m_actor->attachShape(*shape);
+    }
+    Physics::set_actor_entity(*m_actor, get_entity());
+    reset_pose_history();
+}
+
+void RigidBody::replace_shape(PxShape& shape) {
+    if (!m_actor) {
+        return;
+    }
+    // a rigidbody only ever carries the shape of its game object
+    PxShape* current = nullptr;
+    if (m_actor->getNbShapes() > 0) {
+        m_actor->getShapes(&current, 1);
+    }
+    if (current == &shape) {
+        return;
+    }
+    if (current) {
+        m_actor->detachShape(*current);
+    }
+    m_actor->attachShape(shape);
+    if (PxRigidDynamic* dynamic = get_dynamic()) {
+        PxRigidBodyExt::updateMassAndInertia(*dynamic, m_mass);
     }
 }
 
 PxVec3 RigidBody::get_position_from_transform() {
-    auto sceneOpt = Scene::get_active_scene();
-    if (sceneOpt) {
-        Scene& scene = sceneOpt.value();
-        entt::entity handle = entt::to_entity(scene.get_registry(), *this);
-        auto goOpt = scene.get_game_object_from_handle(handle);
-        ;
-        if (goOpt) {
-            PxVec3 position = vec3_to_PxVec3(goOpt->get_component<components::Transform>().get_position());
-
-            return position;
-        }
+    if (Transform* transform = get_sibling<Transform>()) {
+        return vec3_to_PxVec3(transform->get_position());
     }
     return PxVec3(std::numeric_limits<float>::max());
 }
 
 PxQuat RigidBody::get_rotation_from_transform() {
-    auto sceneOpt = Scene::get_active_scene();
-    if (sceneOpt) {
-        Scene& scene = sceneOpt.value();
-        entt::entity handle = entt::to_entity(scene.get_registry(), *this);
-        auto goOpt = scene.get_game_object_from_handle(handle);
-        if (goOpt) {
-            return quat_to_PxQuat(goOpt->get_component<components::Transform>().get_rotation());
-        }
+    if (Transform* transform = get_sibling<Transform>()) {
+        return quat_to_PxQuat(transform->get_rotation());
     }
     return PxQuat();
 }
 
-std::shared_ptr<PxShape_ptr_wrapper> RigidBody::get_shape_from_shape() {
-    auto sceneOpt = Scene::get_active_scene();
-    if (sceneOpt) {
-        Scene& scene = sceneOpt.value();
-        entt::entity handle = entt::to_entity(scene.get_registry(), *this);
-        auto goOpt = scene.get_game_object_from_handle(handle);
-        if (goOpt) {
-            if (goOpt->has_component<components::Shape>()) {
-                Shape& shape = goOpt->get_component<components::Shape>();
-                return shape.get_shape().lock();
-            }
+PxShape* RigidBody::get_shape_from_shape() {
+    if (Shape* shape = get_sibling<Shape>()) {
+        if (auto pxShape = shape->get_shape().lock()) {
+            return pxShape->get();
         }
     }
     return nullptr;
@@ -160,8 +246,8 @@ PxQuat RigidBody::quat_to_PxQuat(quat q) {
     return PxQuat(q.x, q.y, q.z, q.w);
 }
 void RigidBody::on_load() {
-    this->on_awake();
-    this->create_actor(m_isDynamic, m_mass);
+    // the scene inserts every loaded actor in one batch
+    this->build_actor(m_type == RigidBodyType::Dynamic, m_mass);
 }
 
 }  // namespace components
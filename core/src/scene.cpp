@@ -1,4 +1,5 @@
 #include <knoting/components.h>
+#include <knoting/engine.h>
 #include <knoting/game_object.h>
 #include <knoting/instance_mesh.h>
 #include <knoting/log.h>
@@ -6,16 +7,59 @@
 #include <knoting/spot_light.h>
 #include <knoting/transform.h>
 #include <cereal/archives/json.hpp>
+#include <algorithm>
 
 namespace knot {
 
+// PhysX objects are owned by their component, so they go whichever way the component leaves the registry
+template <typename T>
+static void release_physics_object(entt::registry& registry, entt::entity handle) {
+    registry.get<T>(handle).on_destroy();
+}
+
+// components are emplaced and replaced by value, either way the new instance learns its owner here
+template <typename T>
+static void set_component_owner(entt::registry& registry, entt::entity handle) {
+    registry.get<T>(handle).m_entity = handle;
+}
+
+template <typename T>
+static void connect_component_owner(entt::registry& registry) {
+    registry.on_construct<T>().template connect<&set_component_owner<T>>();
+    registry.on_update<T>().template connect<&set_component_owner<T>>();
+}
+
+// storages added to the snapshot after a scene file was written are missing at its end and stay empty
+template <typename... Component>
+static void load_appended_components(entt::continuous_loader& loader, cereal::JSONInputArchive& archive) {
+    ((archive.getNodeName() ? static_cast<void>(loader.component<Component>(archive)) : static_cast<void>(0)), ...);
+}
+
 entt::registry& Scene::get_registry() {
     return m_registry;
 }
 
+Scene::Scene() {
+    m_registry.on_construct<components::Name>().connect<&Scene::on_name_construct>(*this);
+    m_registry.on_destroy<components::Name>().connect<&Scene::on_name_destroy>(*this);
+    m_registry.on_destroy<components::RigidBody>().connect<&release_physics_object<components::RigidBody>>();
+    m_registry.on_destroy<components::PhysicsAggregate>()
+        .connect<&release_physics_object<components::PhysicsAggregate>>();
+    m_registry.on_destroy<components::CharacterController>()
+        .connect<&release_physics_object<components::CharacterController>>();
+
+    connect_component_owner<components::RigidBody>(m_registry);
+    connect_component_owner<components::RigidController>(m_registry);
+    connect_component_owner<components::Shape>(m_registry);
+    connect_component_owner<components::PhysicsMaterial>(m_registry);
+    connect_component_owner<components::Raycast>(m_registry);
+    connect_component_owner<components::PhysicsAggregate>(m_registry);
+    connect_component_owner<components::CharacterController>(m_registry);
+}
+
 Scene::~Scene() {
-    while (!m_entityGameObjectMap.empty()) {
-        auto it = m_entityGameObjectMap.begin();
+    while (!m_uuidGameObjectMap.empty()) {
+        auto it = m_uuidGameObjectMap.begin();
         remove_game_object(it->second);
     }
 }
@@ -29,7 +73,6 @@ GameObject Scene::create_game_object(const std::string& name) {
     e.add_component<components::Name>(n);
 
     m_uuidGameObjectMap.insert(std::make_pair(e.get_id(), e));
-    m_entityGameObjectMap.insert(std::make_pair(e.m_handle, e));
 
     log::debug("Created game object with id {}", to_string(e.get_id()));
 
@@ -84,13 +127,246 @@ void Scene::remove_game_object(GameObject game_object) {
         removeComponent.invoke(game_object.m_handle);
     }
 
+    auto* pooled = m_registry.try_get<components::Pooled>(game_object.m_handle);
+    if (pooled) {
+        auto poolIt = m_pools.find(pooled->pool);
+        if (poolIt != m_pools.end()) {
+            ObjectPool& objectPool = poolIt->second;
+            auto inactiveIt = std::find(objectPool.inactive.begin(), objectPool.inactive.end(), game_object.m_handle);
+            if (inactiveIt != objectPool.inactive.end()) {
+                objectPool.inactive.erase(inactiveIt);
+                objectPool.statistics.inactive--;
+            } else {
+                objectPool.statistics.active--;
+            }
+        }
+    }
+
     m_uuidGameObjectMap.erase(game_object.get_id());
-    m_entityGameObjectMap.erase(game_object.m_handle);
 
     m_registry.destroy(game_object.m_handle);
     log::debug("Removed game object with id {}", to_string(game_object.get_id()));
 }
 
+GameObject Scene::acquire_pooled_game_object(const std::string& pool,
+                                             const components::Transform& transform,
+                                             const std::function<void(GameObject)>& construct) {
+    ObjectPool& objectPool = m_pools[pool];
+
+    while (!objectPool.inactive.empty()) {
+        entt::entity handle = objectPool.inactive.back();
+        objectPool.inactive.pop_back();
+        objectPool.statistics.inactive--;
+
+        auto goOpt = get_game_object_from_handle(handle);
+        if (!goOpt) {
+            continue;
+        }
+
+        GameObject go = goOpt.value();
+        go.get_component<components::Transform>() = transform;
+        set_game_object_active(go, true);
+
+        objectPool.statistics.hits++;
+        objectPool.statistics.active++;
+        return go;
+    }
+
+    GameObject go = create_game_object(pool);
+    go.get_component<components::Transform>() = transform;
+    m_registry.emplace<components::Pooled>(go.m_handle, pool);
+    if (construct) {
+        construct(go);
+    }
+
+    objectPool.statistics.misses++;
+    objectPool.statistics.active++;
+    return go;
+}
+
+void Scene::release_pooled_game_object(GameObject game_object) {
+    auto* pooled = m_registry.try_get<components::Pooled>(game_object.m_handle);
+    if (!pooled) {
+        log::warn("Game object with id {} does not belong to a pool, removing it instead",
+                  to_string(game_object.get_id()));
+        remove_game_object(game_object);
+        return;
+    }
+
+    if (m_registry.all_of<components::Inactive>(game_object.m_handle)) {
+        return;
+    }
+
+    set_game_object_active(game_object, false);
+
+    ObjectPool& objectPool = m_pools[pooled->pool];
+    objectPool.inactive.push_back(game_object.m_handle);
+    objectPool.statistics.active--;
+    objectPool.statistics.inactive++;
+}
+
+void Scene::clear_pool(const std::string& pool) {
+    auto poolIt = m_pools.find(pool);
+    if (poolIt == m_pools.end()) {
+        return;
+    }
+
+    std::vector<entt::entity> inactive = std::move(poolIt->second.inactive);
+    poolIt->second.inactive.clear();
+    poolIt->second.statistics.inactive = 0;
+
+    for (entt::entity handle : inactive) {
+        m_registry.remove<components::Pooled>(handle);
+        auto goOpt = get_game_object_from_handle(handle);
+        if (goOpt) {
+            remove_game_object(goOpt.value());
+        }
+    }
+}
+
+PoolStatistics Scene::get_pool_statistics(const std::string& pool) const {
+    auto poolIt = m_pools.find(pool);
+    if (poolIt == m_pools.end()) {
+        return PoolStatistics();
+    }
+    return poolIt->second.statistics;
+}
+
+void Scene::set_game_object_active(GameObject game_object, bool active) {
+    entt::entity handle = game_object.m_handle;
+
+    if (active) {
+        m_registry.remove<components::Inactive>(handle);
+    } else {
+        m_registry.emplace_or_replace<components::Inactive>(handle);
+    }
+
+    auto* rigidbody = m_registry.try_get<components::RigidBody>(handle);
+    if (rigidbody) {
+        if (active) {
+            // the pose may have changed while the actor was parked
+            const auto& transform = m_registry.get<components::Transform>(handle);
+            rigidbody->set_transform(transform.get_position(), transform.get_rotation());
+        }
+        rigidbody->set_simulation_enabled(active);
+    }
+
+    auto* character = m_registry.try_get<components::CharacterController>(handle);
+    if (character) {
+        if (active) {
+            // the Transform holds the foot position, it may have moved while the capsule was parked
+            character->teleport(m_registry.get<components::Transform>(handle).get_position());
+        }
+        character->set_simulation_enabled(active);
+    }
+
+    auto* hierarchy = m_registry.try_get<components::Hierarchy>(handle);
+    if (!hierarchy) {
+        return;
+    }
+
+    for (auto& childId : hierarchy->get_children()) {
+        auto childOpt = get_game_object_from_id(childId);
+        if (childOpt) {
+            set_game_object_active(childOpt.value(), active);
+        }
+    }
+}
+
+void Scene::rename_game_object(GameObject game_object, const std::string& name) {
+    auto& component = m_registry.get<components::Name>(game_object.m_handle);
+    StringId id = StringTable::intern(name);
+    if (id == component.m_id) {
+        return;
+    }
+
+    unlink_name(game_object.m_handle, component);
+    component.m_id = id;
+    link_name(game_object.m_handle, component);
+}
+
+std::vector<entt::entity> Scene::view_with_tags(TagMask mask, bool matchAll) {
+    std::vector<entt::entity> result;
+    auto view = m_registry.view<components::Tag>(entt::exclude<components::Inactive>);
+    for (auto [handle, tag] : view.each()) {
+        if (matchAll ? tag.has_all(mask) : tag.has_any(mask)) {
+            result.push_back(handle);
+        }
+    }
+    return result;
+}
+
+std::vector<GameObject> Scene::find_game_objects_by_name(const std::string& name) {
+    std::vector<GameObject> result;
+    auto idOpt = StringTable::find(name);
+    if (!idOpt) {
+        return result;
+    }
+
+    auto it = m_nameIndex.find(idOpt.value());
+    if (it == m_nameIndex.end()) {
+        return result;
+    }
+
+    result.reserve(it->second.size());
+    for (entt::entity handle : it->second) {
+        result.emplace_back(handle, *this);
+    }
+    return result;
+}
+
+std::vector<GameObject> Scene::search_game_objects(const std::string& query) {
+    std::vector<GameObject> result;
+    for (auto& [id, bucket] : m_nameIndex) {
+        if (StringTable::get(id).find(query) == std::string::npos) {
+            continue;
+        }
+        for (entt::entity handle : bucket) {
+            result.emplace_back(handle, *this);
+        }
+    }
+    return result;
+}
+
+void Scene::on_name_construct(entt::registry& registry, entt::entity handle) {
+    link_name(handle, registry.get<components::Name>(handle));
+}
+
+void Scene::on_name_destroy(entt::registry& registry, entt::entity handle) {
+    unlink_name(handle, registry.get<components::Name>(handle));
+}
+
+void Scene::link_name(entt::entity handle, components::Name& name) {
+    auto& bucket = m_nameIndex[name.m_id];
+    name.m_indexSlot = bucket.size();
+    bucket.push_back(handle);
+}
+
+void Scene::unlink_name(entt::entity handle, const components::Name& name) {
+    auto it = m_nameIndex.find(name.m_id);
+    if (it == m_nameIndex.end()) {
+        return;
+    }
+
+    auto& bucket = it->second;
+    size_t slot = name.m_indexSlot;
+    if (slot >= bucket.size() || bucket[slot] != handle) {
+        return;
+    }
+
+    // swap and pop, the entity moved into the hole learns its new slot
+    entt::entity last = bucket.back();
+    bucket[slot] = last;
+    bucket.pop_back();
+    if (last != handle) {
+        m_registry.get<components::Name>(last).m_indexSlot = slot;
+    }
+
+    if (bucket.empty()) {
+        m_nameIndex.erase(it);
+    }
+}
+
 std::optional<GameObject> Scene::get_game_object_from_id(uuid id) {
     auto it = m_uuidGameObjectMap.find(id);
     if (it == m_uuidGameObjectMap.end()) {
@@ -100,11 +376,11 @@ std::optional<GameObject> Scene::get_game_object_from_id(uuid id) {
 }
 
 std::optional<GameObject> Scene::get_game_object_from_handle(entt::entity handle) {
-    auto it = m_entityGameObjectMap.find(handle);
-    if (it == m_entityGameObjectMap.end()) {
+    // a game object is only a handle into the registry, every entity carrying a uuid is one
+    if (!m_registry.valid(handle) || !m_registry.all_of<uuid>(handle)) {
         return std::nullopt;
     }
-    return it->second;
+    return GameObject(handle, *this);
 }
 
 std::optional<std::reference_wrapper<Scene>> Scene::get_active_scene() {
@@ -123,8 +399,11 @@ std::optional<GameObject> Scene::get_game_object_from_component(T& component) {
     }
 
     Scene& scene = sceneOpt.value();
-    entt::entity handle = entt::to_entity(scene.m_registry, component);
-    return scene.get_game_object_from_handle(handle);
+    if constexpr (std::is_base_of_v<components::OwnedComponent, T>) {
+        return scene.get_game_object_from_handle(component.get_entity());
+    } else {
+        return scene.get_game_object_from_handle(entt::to_entity(scene.m_registry, component));
+    }
 }
 
 void Scene::save_scene_to_stream(std::ostream& serialized) {
@@ -135,13 +414,15 @@ void Scene::save_scene_to_stream(std::ostream& serialized) {
         .component<uuid, components::Name, components::Tag, components::Transform, components::Hierarchy,
                    components::Material, components::InstanceMesh, components::SpotLight, components::EditorCamera,
                    components::PhysicsMaterial, components::Shape, components::RigidBody, components::RigidController,
-                   components::Raycast>(archive);
+                   components::Raycast, components::Terrain, components::PhysicsAggregate,
+                   components::CharacterController>(archive);
     log::debug("Scene: Save Finished");
 }
 void Scene::load_scene_from_stream(std::istream& serialized) {
     m_uuidGameObjectMap.clear();
-    m_entityGameObjectMap.clear();
+    m_pools.clear();
     m_registry.clear();
+    m_nameIndex.clear();
 
     cereal::JSONInputArchive archive(serialized);
     // TODO: When you make a new component add it here to the snapshot if it needs to be
@@ -155,17 +436,39 @@ void Scene::load_scene_from_stream(std::istream& serialized) {
                           components::Material, components::InstanceMesh, components::SpotLight,
                           components::EditorCamera, components::PhysicsMaterial, components::Shape,
                           components::RigidBody, components::RigidController, components::Raycast>(archive);
+    load_appended_components<components::Terrain, components::PhysicsAggregate, components::CharacterController>(
+        sceneLoader, archive);
 
     // I know this is horrible but it's already full jank time. Can go back and be rewritten using the meta system
     auto ents = m_registry.view<components::Shape, components::RigidBody>();
-    for (auto ent : ents) {
-        auto goOpt = this->get_game_object_from_handle(ent);
-        if (!goOpt) {
-            continue;
+    std::vector<PxRigidActor*> actors;
+    actors.reserve(ents.size_hint());
+    for (auto [ent, shape, rigidbody] : ents.each()) {
+        shape.on_load();
+        rigidbody.on_load();
+        if (PxRigidActor* actor = rigidbody.get_actor()) {
+            actors.emplace_back(actor);
         }
-        auto go = goOpt.value();
-        go.get_component<components::Shape>().on_load();
-        go.get_component<components::RigidBody>().on_load();
+    }
+    if (Physics* physics = Physics::get_instance()) {
+        physics->add_actors(actors.data(), actors.size());
+    }
+
+    // loaded into a temporary first, the heightmap and chunks are only set up once the registry owns the terrain
+    auto terrains = m_registry.view<components::Terrain>();
+    for (auto [ent, terrain] : terrains.each()) {
+        terrain.on_load();
+    }
+
+    // aggregates pick up the actors of their subtree once those exist
+    auto aggregates = m_registry.view<components::PhysicsAggregate>();
+    for (auto [ent, aggregate] : aggregates.each()) {
+        aggregate.on_load();
+    }
+
+    auto characters = m_registry.view<components::CharacterController>();
+    for (auto [ent, character] : characters.each()) {
+        character.on_load();
     }
 
     auto entsRigCont = m_registry.view<components::RigidController>();
@@ -184,7 +487,6 @@ GameObject Scene::add_game_object(entt::entity handle) {
     GameObject e(handle, *this);
 
     m_uuidGameObjectMap.insert(std::make_pair(e.get_id(), e));
-    m_entityGameObjectMap.insert(std::make_pair(e.m_handle, e));
 
     return e;
 }
@@ -1,44 +1,74 @@
 #include <knoting/engine.h>
+#include <knoting/serialization.h>
 #include <knoting/shape.h>
 #include <cereal/archives/json.hpp>
 
 namespace knot {
 namespace components {
 Shape::Shape() : m_material(nullptr), m_shape(nullptr) {}
-Shape::~Shape() {}
 
 void Shape::on_awake() {
-    auto engineOpt = Engine::get_active_engine();
-    if (engineOpt) {
-        Engine& engine = engineOpt.value();
-        m_physics = engine.get_physics_module().lock()->get_physics().lock();
-    }
-    if (get_PxMaterial_from_pxmaterial()) {
-        m_material = get_PxMaterial_from_pxmaterial();
+    if (auto material = get_PxMaterial_from_pxmaterial()) {
+        m_material = material;
     } else {
         constexpr PxReal default_staticFriction = 0.3f;
         constexpr PxReal default_dynamicFriction = 0.3f;
         constexpr PxReal default_restitution = 0.6f;
-        m_material = std::make_shared<PxMaterial_ptr_wrapper>(
-            m_physics->get()->createMaterial(default_staticFriction, default_dynamicFriction, default_restitution));
+        m_material = Physics::get_physics_cache()->acquire_material(default_staticFriction, default_dynamicFriction,
+                                                                    default_restitution);
     }
 }
 
-void Shape::on_destroy() {}
+void Shape::on_destroy() {
+    m_shape.reset();
+    m_material.reset();
+}
 
-void Shape::set_geometry(const PxGeometry& geometry) {
-    if (!m_shape) {
-        m_shape = std::make_shared<PxShape_ptr_wrapper>(m_physics->get()->createShape(geometry, *m_material->get()));
+void Shape::set_material(std::shared_ptr<PxMaterial_ptr_wrapper> material) {
+    m_material = material;
+    acquire_shape();
+}
 
-    } else {
-        m_shape->get()->setGeometry(geometry);
+void Shape::set_geometry(const PxGeometry& geometry) {
+    if (geometry.getType() != PxGeometryType::eCONVEXMESH && geometry.getType() != PxGeometryType::eTRIANGLEMESH) {
+        m_meshPath.clear();
     }
+    m_geometry.storeAny(geometry);
+    m_hasGeometry = true;
+    acquire_shape();
 }
 
 void Shape::set_local_rotation(quat rotation) {
-    if (m_shape) {
-        m_shape->get()->setLocalPose(PxTransform(RigidBody::quat_to_PxQuat(rotation)));
+    m_localPose = PxTransform(RigidBody::quat_to_PxQuat(rotation));
+    acquire_shape();
+}
+
+void Shape::set_layer(CollisionLayer layer) {
+    m_layer = layer % MAX_COLLISION_LAYERS;
+    acquire_shape();
+}
+
+void Shape::set_trigger(bool isTrigger) {
+    m_isTrigger = isTrigger;
+    acquire_shape();
+}
+
+void Shape::acquire_shape() {
+    PhysicsCache* cache = Physics::get_physics_cache();
+    if (!m_hasGeometry || !m_material || !cache) {
+        return;
+    }
+
+    auto shape = cache->acquire_shape(m_geometry.any(), *m_material->get(), m_localPose, m_layer, m_isTrigger);
+    if (!shape || shape == m_shape) {
+        return;
+    }
+
+    // an actor already built from the previous shape takes the new one
+    if (RigidBody* rigidbody = get_sibling<RigidBody>()) {
+        rigidbody->replace_shape(*shape->get());
     }
+    m_shape = shape;
 }
 
 PxBoxGeometry Shape::create_cube_geometry(const vec3& halfsize) {
@@ -53,18 +83,27 @@ PxCapsuleGeometry Shape::create_capsule_geometry(const float& radius, const floa
     return PxCapsuleGeometry(radius, halfheight);
 }
 
+PxConvexMeshGeometry Shape::create_convex_geometry(const std::string& meshPath, const vec3& scale) {
+    m_meshPath = meshPath;
+    PxConvexMesh* mesh = Physics::get_collision_cooker()->acquire_convex_mesh(meshPath);
+    if (!mesh) {
+        return PxConvexMeshGeometry();
+    }
+    return PxConvexMeshGeometry(mesh, PxMeshScale(RigidBody::vec3_to_PxVec3(scale)));
+}
+
+PxTriangleMeshGeometry Shape::create_triangle_mesh_geometry(const std::string& meshPath, const vec3& scale) {
+    m_meshPath = meshPath;
+    PxTriangleMesh* mesh = Physics::get_collision_cooker()->acquire_triangle_mesh(meshPath);
+    if (!mesh) {
+        return PxTriangleMeshGeometry();
+    }
+    return PxTriangleMeshGeometry(mesh, PxMeshScale(RigidBody::vec3_to_PxVec3(scale)));
+}
+
 std::shared_ptr<PxMaterial_ptr_wrapper> Shape::get_PxMaterial_from_pxmaterial() {
-    auto sceneOpt = Scene::get_active_scene();
-    if (sceneOpt) {
-        Scene& scene = sceneOpt.value();
-        entt::entity handle = entt::to_entity(scene.get_registry(), *this);
-        auto goOpt = scene.get_game_object_from_handle(handle);
-        if (goOpt) {
-            if (goOpt->has_component<components::PhysicsMaterial>()) {
-                PhysicsMaterial& pm = goOpt->get_component<components::PhysicsMaterial>();
-                return pm.get_px_material().lock();
-            }
-        }
+    if (PhysicsMaterial* material = get_sibling<PhysicsMaterial>()) {
+        return material->get_px_material().lock();
     }
     return nullptr;
 }
@@ -94,20 +133,47 @@ void Shape::save(Archive& archive) const {
             shapeSize = vec3(capsuleGeometry.radius, capsuleGeometry.halfHeight, 0);
             break;
         }
+        case PxGeometryType::Enum::eCONVEXMESH: {
+            PxConvexMeshGeometry convexGeometry;
+            m_shape->get()->getConvexMeshGeometry(convexGeometry);
+            shapeSize = RigidBody::PxVec3_to_vec3(convexGeometry.scale.scale);
+            break;
+        }
+        case PxGeometryType::Enum::eTRIANGLEMESH: {
+            PxTriangleMeshGeometry triangleGeometry;
+            m_shape->get()->getTriangleMeshGeometry(triangleGeometry);
+            shapeSize = RigidBody::PxVec3_to_vec3(triangleGeometry.scale.scale);
+            break;
+        }
         default:
             log::debug("Shape Save: Geometry Type not Found");
             break;
     }
-    archive(CEREAL_NVP(shapeType), CEREAL_NVP(shapeSize));
+    // cooked shapes store their scale in shapeSize and the source mesh in meshPath
+    std::string meshPath = m_meshPath;
+    uint32_t layer = m_layer;
+    bool isTrigger = m_isTrigger;
+    archive(CEREAL_NVP(shapeType), CEREAL_NVP(shapeSize), CEREAL_NVP(meshPath), CEREAL_NVP(layer),
+            CEREAL_NVP(isTrigger));
 }
 
 template <class Archive>
 void Shape::load(Archive& archive) {
     vec3 shapeSize;
     PxGeometryType::Enum shapeType;
+    std::string meshPath;
+    uint32_t layer = 0;
+    bool isTrigger = false;
     archive(CEREAL_NVP(shapeType), CEREAL_NVP(shapeSize));
+    // scenes saved before mesh colliders, layers and triggers have none of these
+    load_optional_nvp(archive, "meshPath", meshPath);
+    load_optional_nvp(archive, "layer", layer);
+    load_optional_nvp(archive, "isTrigger", isTrigger);
+    m_layer = static_cast<CollisionLayer>(layer % MAX_COLLISION_LAYERS);
+    m_isTrigger = isTrigger;
     m_shapeType = shapeType;
     m_shapeSize = shapeSize;
+    m_meshPath = meshPath;
 }
 
 void Shape::on_load() {
@@ -125,6 +191,14 @@ void Shape::on_load() {
             this->set_geometry(this->create_capsule_geometry(m_shapeSize.x, m_shapeSize.y));
             break;
         }
+        case PxGeometryType::Enum::eCONVEXMESH: {
+            this->set_geometry(this->create_convex_geometry(m_meshPath, m_shapeSize));
+            break;
+        }
+        case PxGeometryType::Enum::eTRIANGLEMESH: {
+            this->set_geometry(this->create_triangle_mesh_geometry(m_meshPath, m_shapeSize));
+            break;
+        }
         default:
             log::debug("Shape Load: Geometry Type not Found");
             break;
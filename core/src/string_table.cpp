@@ -0,0 +1,51 @@
+#include <knoting/assert.h>
+#include <knoting/string_table.h>
+
+#include <mutex>
+
+namespace knot {
+
+StringId StringTable::intern(std::string_view string) {
+    {
+        std::shared_lock lock(s_mutex);
+        auto it = s_ids.find(string);
+        if (it != s_ids.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(s_mutex);
+    // another thread may have interned it between the two locks
+    auto it = s_ids.find(string);
+    if (it != s_ids.end()) {
+        return it->second;
+    }
+
+    StringId id = (StringId)s_strings.size();
+    // deque never relocates its elements, the views used as keys stay valid
+    const std::string& stored = s_strings.emplace_back(string);
+    s_ids.insert({std::string_view(stored), id});
+    return id;
+}
+
+std::optional<StringId> StringTable::find(std::string_view string) {
+    std::shared_lock lock(s_mutex);
+    auto it = s_ids.find(string);
+    if (it == s_ids.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const std::string& StringTable::get(StringId id) {
+    std::shared_lock lock(s_mutex);
+    KNOTING_ASSERT_MESSAGE(id < s_strings.size(), "StringId {} was never interned", id);
+    return s_strings[id];
+}
+
+size_t StringTable::size() {
+    std::shared_lock lock(s_mutex);
+    return s_strings.size();
+}
+
+}  // namespace knot
@@ -0,0 +1,142 @@
+#include <knoting/log.h>
+#include <knoting/scene.h>
+#include <knoting/system_scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace knot {
+
+System::System(const std::string& name, std::function<void(Scene&)> update) : m_name(name), m_update(update) {}
+
+bool System::conflicts_with(const System& other) const {
+    auto intersects = [](const std::vector<ResourceId>& a, const std::vector<ResourceId>& b) {
+        for (ResourceId id : a) {
+            if (std::find(b.begin(), b.end(), id) != b.end()) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    return intersects(m_writes, other.m_reads) || intersects(m_writes, other.m_writes) ||
+           intersects(m_reads, other.m_writes);
+}
+
+SystemScheduler::SystemScheduler(JobSystem& jobSystem) : m_jobSystem(jobSystem) {}
+
+void SystemScheduler::add_system(const System& system) {
+    m_systems.emplace_back(system);
+    m_dirty = true;
+}
+
+void SystemScheduler::remove_system(const std::string& name) {
+    m_systems.erase(std::remove_if(m_systems.begin(), m_systems.end(),
+                                   [&name](const System& system) { return system.m_name == name; }),
+                    m_systems.end());
+    m_dirty = true;
+}
+
+void SystemScheduler::run(Scene& scene) {
+    if (m_dirty) {
+        build_graph();
+    }
+
+    // Views and groups create their storages on first use, which inserts into the registry's pool map, and EnTT does
+    // not guard that against concurrent readers. One frame in add order on a new scene lets every system create what
+    // it touches before the waves share the registry between threads.
+    m_lastRunSerial = m_lastScene != &scene;
+    if (m_lastRunSerial) {
+        m_lastScene = &scene;
+        log::debug("System scheduler running {} systems serially on the first frame of a scene", m_systems.size());
+        for (size_t i = 0; i < m_systems.size(); ++i) {
+            run_system(i, scene);
+        }
+        return;
+    }
+
+    for (auto& wave : m_waves) {
+        JobHandle counter = std::make_shared<JobCounter>();
+        // the calling thread runs the main thread systems of the wave, or takes the first system itself if there are
+        // none
+        const bool hasMainThread = std::any_of(wave.begin(), wave.end(),
+                                               [this](size_t index) { return m_systems[index].m_mainThread; });
+        const size_t callerIndex = hasMainThread ? SIZE_MAX : wave[0];
+        for (size_t index : wave) {
+            if (!m_systems[index].m_mainThread && index != callerIndex) {
+                m_jobSystem.submit([this, &scene, index]() { run_system(index, scene); }, counter);
+            }
+        }
+        for (size_t index : wave) {
+            if (m_systems[index].m_mainThread || index == callerIndex) {
+                run_system(index, scene);
+            }
+        }
+        m_jobSystem.wait(counter);
+    }
+}
+
+const std::vector<SystemNode>& SystemScheduler::get_graph() {
+    if (m_dirty) {
+        build_graph();
+    }
+    return m_nodes;
+}
+
+void SystemScheduler::log_graph() {
+    const auto& nodes = get_graph();
+    if (m_lastRunSerial) {
+        log::debug("System graph of {} waves, the last frame ran serially in add order (first frame of a scene), the "
+                   "timings below are from that run",
+                   m_waves.size());
+    } else {
+        log::debug("System graph of {} waves", m_waves.size());
+    }
+    for (size_t wave = 0; wave < m_waves.size(); ++wave) {
+        for (size_t index : m_waves[wave]) {
+            std::string dependencies;
+            for (size_t dependency : nodes[index].dependencies) {
+                dependencies += nodes[dependency].name + " ";
+            }
+            log::debug("System wave {} : {}{} ({:.3f} ms) after [ {}]", wave, nodes[index].name,
+                       m_systems[index].m_mainThread ? " (main thread)" : "", nodes[index].lastDurationMs,
+                       dependencies);
+        }
+    }
+}
+
+void SystemScheduler::build_graph() {
+    m_nodes.clear();
+    m_waves.clear();
+
+    for (size_t i = 0; i < m_systems.size(); ++i) {
+        SystemNode node;
+        node.name = m_systems[i].m_name;
+
+        for (size_t j = 0; j < i; ++j) {
+            if (!m_systems[i].conflicts_with(m_systems[j])) {
+                continue;
+            }
+            node.dependencies.push_back(j);
+            node.wave = std::max(node.wave, m_nodes[j].wave + 1);
+        }
+
+        if (m_waves.size() <= node.wave) {
+            m_waves.resize(node.wave + 1);
+        }
+        m_waves[node.wave].push_back(i);
+        m_nodes.emplace_back(node);
+    }
+
+    m_dirty = false;
+}
+
+void SystemScheduler::run_system(size_t index, Scene& scene) {
+    auto start = std::chrono::high_resolution_clock::now();
+    m_systems[index].m_update(scene);
+    auto stop = std::chrono::high_resolution_clock::now();
+    m_nodes[index].lastDurationMs = std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+}  // namespace knot
@@ -0,0 +1,390 @@
+#include <knoting/asset_manager.h>
+#include <knoting/camera.h>
+#include <knoting/engine.h>
+#include <knoting/game_object.h>
+#include <knoting/log.h>
+#include <knoting/physics.h>
+#include <knoting/scene.h>
+#include <knoting/terrain.h>
+#include <cereal/archives/json.hpp>
+#include <stb_image.h>
+
+#include <algorithm>
+
+namespace knot {
+namespace components {
+
+float Heightmap::sample(int32_t x, int32_t z) const {
+    x = std::clamp<int32_t>(x, 0, static_cast<int32_t>(width) - 1);
+    z = std::clamp<int32_t>(z, 0, static_cast<int32_t>(depth) - 1);
+    return heights[static_cast<size_t>(z) * width + x];
+}
+
+TerrainChunk::~TerrainChunk() {
+    for (auto& chunkLod : lods) {
+        if (bgfx::isValid(chunkLod.vbh)) {
+            bgfx::destroy(chunkLod.vbh);
+        }
+        if (bgfx::isValid(chunkLod.ibh)) {
+            bgfx::destroy(chunkLod.ibh);
+        }
+    }
+    // PhysX objects die with their PxPhysics, once the physics module is gone there is nothing left to release
+    if (!Physics::get_instance()) {
+        return;
+    }
+    if (actor) {
+        actor->release();
+    }
+    shape.reset();
+    if (heightField) {
+        heightField->release();
+    }
+}
+
+Terrain::Terrain() {}
+
+Terrain::Terrain(const std::string& heightmapPath, const vec3& scale, uint32_t chunkSize, float streamRadius)
+    : m_heightmapPath(heightmapPath), m_scale(scale), m_chunkSize(chunkSize), m_streamRadius(streamRadius) {}
+
+void Terrain::on_awake() {
+    auto engineOpt = Engine::get_active_engine();
+    if (engineOpt) {
+        m_jobSystem = engineOpt.value().get_job_system().lock();
+    }
+
+    PhysicsCache* cache = Physics::get_physics_cache();
+    if (!m_jobSystem || !cache) {
+        log::error("terrain {} needs the job system and the physics module", m_heightmapPath);
+        return;
+    }
+
+    constexpr PxReal ground_staticFriction = 0.6f;
+    constexpr PxReal ground_dynamicFriction = 0.6f;
+    constexpr PxReal ground_restitution = 0.1f;
+    m_material = cache->acquire_material(ground_staticFriction, ground_dynamicFriction, ground_restitution);
+
+    // every lod step has to land on a whole sample
+    m_chunkSize = std::clamp<uint32_t>(m_chunkSize, 1u << (LOD_COUNT - 1), MAX_CHUNK_SIZE);
+
+    m_chunks.clear();
+    if (!load_heightmap()) {
+        return;
+    }
+
+    const uint32_t chunksX = (m_heightmap->width - 2) / m_chunkSize + 1;
+    const uint32_t chunksZ = (m_heightmap->depth - 2) / m_chunkSize + 1;
+    for (uint32_t z = 0; z < chunksZ; ++z) {
+        for (uint32_t x = 0; x < chunksX; ++x) {
+            auto chunk = std::make_shared<TerrainChunk>();
+            chunk->x = x;
+            chunk->z = z;
+            const float sizeX = static_cast<float>(std::min(m_chunkSize, m_heightmap->width - 1 - x * m_chunkSize));
+            const float sizeZ = static_cast<float>(std::min(m_chunkSize, m_heightmap->depth - 1 - z * m_chunkSize));
+            chunk->center = vec3((x * m_chunkSize + sizeX * 0.5f) * m_scale.x, 0.0f,
+                                 (z * m_chunkSize + sizeZ * 0.5f) * m_scale.z);
+            m_chunks.emplace_back(chunk);
+        }
+    }
+    log::debug("terrain {} split into {}x{} chunks", m_heightmapPath, chunksX, chunksZ);
+}
+
+void Terrain::on_load() {
+    on_awake();
+}
+
+void Terrain::on_destroy() {
+    if (m_jobSystem) {
+        for (auto& job : m_pendingJobs) {
+            m_jobSystem->wait(job);
+        }
+    }
+    m_pendingJobs.clear();
+
+    for (auto& chunk : m_chunks) {
+        release_chunk(*chunk);
+    }
+    m_material.reset();
+}
+
+void Terrain::stream_terrains(Scene& scene) {
+    entt::registry& registry = scene.get_registry();
+
+    auto cameras = registry.view<Transform, EditorCamera>();
+    if (cameras.begin() == cameras.end()) {
+        return;
+    }
+    const vec3 cameraPosition = cameras.get<Transform>(*cameras.begin()).get_position();
+
+    auto terrains = registry.view<Terrain, Transform>(entt::exclude<Inactive>);
+    for (auto [e, terrain, transform] : terrains.each()) {
+        terrain.update_streaming(cameraPosition, transform.get_position(), e);
+    }
+}
+
+void Terrain::update_streaming(const vec3& cameraPosition, const vec3& terrainPosition, entt::entity entity) {
+    CollisionCooker* cooker = Physics::get_collision_cooker();
+    if (!m_heightmap || !m_material || !cooker) {
+        return;
+    }
+
+    m_pendingJobs.erase(std::remove_if(m_pendingJobs.begin(), m_pendingJobs.end(),
+                                       [](const JobHandle& job) { return job->is_done(); }),
+                        m_pendingJobs.end());
+
+    const vec3 localCamera = cameraPosition - terrainPosition;
+
+    for (auto& chunk : m_chunks) {
+        const float distance =
+            glm::distance(vec2(localCamera.x, localCamera.z), vec2(chunk->center.x, chunk->center.z));
+        const bool wanted = distance <= m_streamRadius;
+
+        switch (chunk->state.load(std::memory_order_acquire)) {
+            case TerrainChunkState::Unloaded: {
+                if (!wanted) {
+                    break;
+                }
+                chunk->state.store(TerrainChunkState::Building, std::memory_order_relaxed);
+                // the job holds its own references, a terrain destroyed mid build can not pull the data away, the
+                // cooker outlives it since on_destroy waits for the job before physics shuts down
+                m_pendingJobs.emplace_back(
+                    m_jobSystem->submit([chunk, heightmap = m_heightmap, scale = m_scale, chunkSize = m_chunkSize,
+                                         cooker]() {
+                        build_chunk(*chunk, *heightmap, scale, chunkSize, *cooker);
+                        chunk->state.store(TerrainChunkState::Built, std::memory_order_release);
+                    }));
+                break;
+            }
+            case TerrainChunkState::Built: {
+                if (wanted) {
+                    upload_chunk(*chunk, terrainPosition, entity);
+                } else {
+                    release_chunk(*chunk);
+                }
+                break;
+            }
+            case TerrainChunkState::Resident: {
+                if (!wanted) {
+                    release_chunk(*chunk);
+                    break;
+                }
+                chunk->lod = std::min(LOD_COUNT - 1, static_cast<uint32_t>(distance / m_lodDistance));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+float Terrain::get_height(float x, float z) const {
+    if (!m_heightmap) {
+        return 0.0f;
+    }
+    const float sampleX = x / m_scale.x;
+    const float sampleZ = z / m_scale.z;
+    if (sampleX < 0.0f || sampleZ < 0.0f || sampleX > m_heightmap->width - 1 || sampleZ > m_heightmap->depth - 1) {
+        return 0.0f;
+    }
+
+    const int32_t x0 = static_cast<int32_t>(sampleX);
+    const int32_t z0 = static_cast<int32_t>(sampleZ);
+    const float fx = sampleX - x0;
+    const float fz = sampleZ - z0;
+    const float top = glm::mix(m_heightmap->sample(x0, z0), m_heightmap->sample(x0 + 1, z0), fx);
+    const float bottom = glm::mix(m_heightmap->sample(x0, z0 + 1), m_heightmap->sample(x0 + 1, z0 + 1), fx);
+    return glm::mix(top, bottom, fz) * m_scale.y;
+}
+
+bool Terrain::load_heightmap() {
+    std::filesystem::path path = AssetManager::get_resources_path().append(PATH_TEXTURE).append(m_heightmapPath);
+
+    int width = 0;
+    int depth = 0;
+    int channels = 0;
+    // 8 bit images are widened, 16 bit heightmaps keep their precision
+    stbi_us* pixels = stbi_load_16(path.string().c_str(), &width, &depth, &channels, 1);
+    if (!pixels) {
+        log::error("terrain could not load heightmap {}", path.string());
+        return false;
+    }
+    if (width < 2 || depth < 2) {
+        log::error("terrain heightmap {} is too small", path.string());
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    auto heightmap = std::make_shared<Heightmap>();
+    heightmap->width = static_cast<uint32_t>(width);
+    heightmap->depth = static_cast<uint32_t>(depth);
+    heightmap->heights.resize(heightmap->width * heightmap->depth);
+    for (size_t i = 0; i < heightmap->heights.size(); ++i) {
+        heightmap->heights[i] = pixels[i] / 65535.0f;
+    }
+    stbi_image_free(pixels);
+
+    m_heightmap = heightmap;
+    return true;
+}
+
+void Terrain::build_chunk(TerrainChunk& chunk,
+                          const Heightmap& heightmap,
+                          const vec3& scale,
+                          uint32_t chunkSize,
+                          CollisionCooker& cooker) {
+    const uint32_t x0 = chunk.x * chunkSize;
+    const uint32_t z0 = chunk.z * chunkSize;
+    // the last chunk of a row is cut short by the heightmap edge
+    const uint32_t sizeX = std::min(chunkSize, heightmap.width - 1 - x0);
+    const uint32_t sizeZ = std::min(chunkSize, heightmap.depth - 1 - z0);
+
+    //=RENDER LODS===========
+    chunk.lods.clear();
+    chunk.lods.resize(LOD_COUNT);
+    for (uint32_t lod = 0; lod < LOD_COUNT; ++lod) {
+        const uint32_t step = 1u << lod;
+
+        // sample offsets of this lod, the chunk border is always kept so neighbours share their edge positions
+        auto offsets = [step](uint32_t size) {
+            std::vector<uint32_t> result;
+            for (uint32_t i = 0; i < size; i += step) {
+                result.emplace_back(i);
+            }
+            result.emplace_back(size);
+            return result;
+        };
+        const std::vector<uint32_t> xs = offsets(sizeX);
+        const std::vector<uint32_t> zs = offsets(sizeZ);
+
+        TerrainChunkLod& chunkLod = chunk.lods[lod];
+        chunkLod.vertices.reserve(xs.size() * zs.size());
+        for (uint32_t localZ : zs) {
+            for (uint32_t localX : xs) {
+                const int32_t sx = static_cast<int32_t>(x0 + localX);
+                const int32_t sz = static_cast<int32_t>(z0 + localZ);
+
+                const float height = heightmap.sample(sx, sz);
+                const float slopeX = (heightmap.sample(sx + 1, sz) - heightmap.sample(sx - 1, sz)) * scale.y /
+                                     (2.0f * scale.x);
+                const float slopeZ = (heightmap.sample(sx, sz + 1) - heightmap.sample(sx, sz - 1)) * scale.y /
+                                     (2.0f * scale.z);
+                const vec3 normal = glm::normalize(vec3(-slopeX, 1.0f, -slopeZ));
+
+                chunkLod.vertices.emplace_back(VertexLayout{
+                    sx * scale.x, height * scale.y, sz * scale.z, encode_normal_rgba8(normal.x, normal.y, normal.z), 0,
+                    static_cast<float>(sx) / (heightmap.width - 1), static_cast<float>(sz) / (heightmap.depth - 1)});
+            }
+        }
+
+        const uint32_t rowLength = static_cast<uint32_t>(xs.size());
+        for (uint32_t z = 0; z + 1 < zs.size(); ++z) {
+            for (uint32_t x = 0; x + 1 < xs.size(); ++x) {
+                const uint16_t i0 = static_cast<uint16_t>(z * rowLength + x);
+                const uint16_t i1 = static_cast<uint16_t>(i0 + 1);
+                const uint16_t i2 = static_cast<uint16_t>(i0 + rowLength);
+                const uint16_t i3 = static_cast<uint16_t>(i2 + 1);
+                chunkLod.indices.insert(chunkLod.indices.end(), {i0, i2, i1, i1, i2, i3});
+            }
+        }
+    }
+
+    //=COLLISION=============
+    // rows run along x and columns along z, heights are quantized to the full int16 range
+    const uint32_t rows = sizeX + 1;
+    const uint32_t columns = sizeZ + 1;
+    std::vector<PxHeightFieldSample> samples(rows * columns);
+    for (uint32_t row = 0; row < rows; ++row) {
+        for (uint32_t column = 0; column < columns; ++column) {
+            PxHeightFieldSample& sample = samples[row * columns + column];
+            sample.height = static_cast<PxI16>(heightmap.sample(x0 + row, z0 + column) * 32767.0f);
+            sample.materialIndex0 = 0;
+            sample.materialIndex1 = 0;
+        }
+    }
+
+    PxHeightFieldDesc desc;
+    desc.format = PxHeightFieldFormat::eS16_TM;
+    desc.nbRows = rows;
+    desc.nbColumns = columns;
+    desc.samples.data = samples.data();
+    desc.samples.stride = sizeof(PxHeightFieldSample);
+    chunk.heightField = cooker.create_height_field(desc);
+}
+
+void Terrain::upload_chunk(TerrainChunk& chunk, const vec3& terrainPosition, entt::entity entity) {
+    VertexLayout::init();
+    for (auto& chunkLod : chunk.lods) {
+        chunkLod.vbh = bgfx::createVertexBuffer(
+            bgfx::copy(chunkLod.vertices.data(), sizeof(VertexLayout) * chunkLod.vertices.size()),
+            VertexLayout::s_meshVertexLayout);
+        chunkLod.ibh =
+            bgfx::createIndexBuffer(bgfx::copy(chunkLod.indices.data(), sizeof(uint16_t) * chunkLod.indices.size()));
+        // bgfx keeps its own copy
+        chunkLod.vertices = std::vector<VertexLayout>();
+        chunkLod.indices = std::vector<uint16_t>();
+    }
+
+    if (chunk.heightField) {
+        PxHeightFieldGeometry geometry(chunk.heightField, PxMeshGeometryFlags(), m_scale.y / 32767.0f, m_scale.x,
+                                       m_scale.z);
+        chunk.shape = Physics::get_physics_cache()->acquire_shape(geometry, *m_material->get());
+
+        // only the terrain position is applied, rotation and scale of the Transform are ignored by the collision
+        const PxVec3 origin(terrainPosition.x + chunk.x * m_chunkSize * m_scale.x, terrainPosition.y,
+                            terrainPosition.z + chunk.z * m_chunkSize * m_scale.z);
+        chunk.actor = Physics::get_px_physics()->createRigidStatic(PxTransform(origin));
+        if (chunk.actor && chunk.shape) {
+            chunk.actor->attachShape(*chunk.shape->get());
+            Physics::set_actor_entity(*chunk.actor, entity);
+            // actors can not join the scene mid step
+            Physics::get_instance()->end_simulation();
+            Physics::get_px_scene()->addActor(*chunk.actor);
+        }
+    } else {
+        log::warn("terrain chunk {} {} has no collision", chunk.x, chunk.z);
+    }
+
+    chunk.state.store(TerrainChunkState::Resident, std::memory_order_relaxed);
+}
+
+void Terrain::release_chunk(TerrainChunk& chunk) {
+    TerrainChunkState state = chunk.state.load(std::memory_order_acquire);
+    if (state != TerrainChunkState::Built && state != TerrainChunkState::Resident) {
+        return;
+    }
+
+    // actors die with their PxPhysics, once the physics module is gone there is nothing left to release
+    if (Physics* physics = Physics::get_instance()) {
+        if (chunk.actor) {
+            // actors can not leave the scene mid step, and contacts of the step still resolve to the terrain
+            physics->end_simulation();
+            if (PxScene* scene = chunk.actor->getScene()) {
+                physics->note_removed_actor(*chunk.actor);
+                scene->removeActor(*chunk.actor);
+            }
+            chunk.actor->release();
+        }
+        chunk.shape.reset();
+        if (chunk.heightField) {
+            chunk.heightField->release();
+        }
+    }
+    chunk.actor = nullptr;
+    chunk.shape.reset();
+    chunk.heightField = nullptr;
+    for (auto& chunkLod : chunk.lods) {
+        if (bgfx::isValid(chunkLod.vbh)) {
+            bgfx::destroy(chunkLod.vbh);
+        }
+        if (bgfx::isValid(chunkLod.ibh)) {
+            bgfx::destroy(chunkLod.ibh);
+        }
+    }
+    chunk.lods.clear();
+    chunk.lod = 0;
+
+    chunk.state.store(TerrainChunkState::Unloaded, std::memory_order_relaxed);
+}
+
+}  // namespace components
+}  // namespace knot
@@ -0,0 +1,135 @@
+#include <knoting/uuid_generator.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+
+namespace knot {
+
+namespace {
+
+uint64_t mix64(uint64_t value) {
+    // splitmix64 finalizer
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+struct RandomState {
+    RandomState() {
+        std::random_device randomDevice;
+        std::array<int, std::mt19937::state_size> seedData;
+        std::generate(std::begin(seedData), std::end(seedData), std::ref(randomDevice));
+        std::seed_seq seedSequences(std::begin(seedData), std::end(seedData));
+
+        randomGenerator = std::mt19937(seedSequences);
+        uuidGenerator = std::make_unique<uuids::uuid_random_generator>(randomGenerator);
+    }
+
+    std::mt19937 randomGenerator;
+    std::unique_ptr<uuids::uuid_random_generator> uuidGenerator;
+};
+
+struct TimeOrderedState {
+    TimeOrderedState() {
+        std::random_device randomDevice;
+        seed = (uint64_t(randomDevice()) << 32) ^ uint64_t(randomDevice());
+    }
+
+    uint64_t next() {
+        seed += 0x9e3779b97f4a7c15ULL;
+        return mix64(seed);
+    }
+
+    uint64_t seed = 0;
+    uint64_t lastMilliseconds = 0;
+    uint16_t counter = 0;
+};
+
+// lazily created on first use per thread, workers that never create game objects pay nothing
+thread_local std::unique_ptr<RandomState> t_randomState;
+thread_local std::unique_ptr<TimeOrderedState> t_timeOrderedState;
+
+}  // namespace
+
+UUIDGenerator::UUIDGenerator(UUIDMode mode) : m_mode(mode) {}
+
+uuid UUIDGenerator::generate() {
+    switch (m_mode) {
+        case UUIDMode::Random:
+            return generate_random();
+        case UUIDMode::TimeOrdered:
+        default:
+            return generate_time_ordered();
+    }
+}
+
+uuid UUIDGenerator::generate_random() {
+    if (!t_randomState) {
+        t_randomState = std::make_unique<RandomState>();
+    }
+    return (*t_randomState->uuidGenerator)();
+}
+
+uuid UUIDGenerator::generate_time_ordered() {
+    if (!t_timeOrderedState) {
+        t_timeOrderedState = std::make_unique<TimeOrderedState>();
+    }
+    TimeOrderedState& state = *t_timeOrderedState;
+
+    constexpr uint16_t maxCounter = 0x0FFF;
+    const uint64_t milliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+
+    if (milliseconds > state.lastMilliseconds) {
+        state.lastMilliseconds = milliseconds;
+        // start low in the counter range so a burst within the same millisecond rarely overflows
+        state.counter = uint16_t(state.next() & (maxCounter >> 1));
+    } else if (state.counter < maxCounter) {
+        state.counter++;
+    } else {
+        // counter exhausted, borrow the next millisecond to stay monotonic on this thread
+        state.lastMilliseconds++;
+        state.counter = 0;
+    }
+
+    const uint64_t timestamp = state.lastMilliseconds;
+    const uint64_t randomBits = state.next();
+
+    // RFC 9562 layout: 48 bit timestamp | version | 12 bit counter | variant | 62 random bits
+    std::array<uint8_t, 16> bytes;
+    bytes[0] = uint8_t(timestamp >> 40);
+    bytes[1] = uint8_t(timestamp >> 32);
+    bytes[2] = uint8_t(timestamp >> 24);
+    bytes[3] = uint8_t(timestamp >> 16);
+    bytes[4] = uint8_t(timestamp >> 8);
+    bytes[5] = uint8_t(timestamp);
+    bytes[6] = uint8_t(0x70 | ((state.counter >> 8) & 0x0F));
+    bytes[7] = uint8_t(state.counter);
+    bytes[8] = uint8_t(0x80 | ((randomBits >> 56) & 0x3F));
+    for (size_t i = 9; i < bytes.size(); ++i) {
+        bytes[i] = uint8_t(randomBits >> ((15 - i) * 8));
+    }
+
+    return uuid(bytes.begin(), bytes.end());
+}
+
+size_t UUIDHash::operator()(const uuid& id) const noexcept {
+    auto bytes = id.as_bytes();
+
+    uint64_t high;
+    uint64_t low;
+    std::memcpy(&high, bytes.data(), sizeof(high));
+    std::memcpy(&low, bytes.data() + sizeof(high), sizeof(low));
+
+    return size_t(mix64(high ^ mix64(low)));
+}
+
+}  // namespace knot
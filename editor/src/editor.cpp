@@ -145,8 +145,10 @@ Editor::Editor() {
 
     auto widgetManager = std::make_shared<WidgetSubsystem>(m_engine);
     auto demoWidget = std::make_shared<DemoWidget>("demo");
+    auto physicsStatsWidget = std::make_shared<PhysicsStatsWidget>("physics", m_engine);
 
     widgetManager->add_widget(demoWidget);
+    widgetManager->add_widget(physicsStatsWidget);
     m_engine->add_subsystem(widgetManager);
 }
 
@@ -3,6 +3,7 @@
 
 #include <knoting/engine.h>
 #include "demo_widget.h"
+#include "physics_stats_widget.h"
 
 namespace knot {
 class Window;
@@ -0,0 +1,39 @@
+#include "physics_stats_widget.h"
+#include <knoting/physics.h>
+
+knot::PhysicsStatsWidget::PhysicsStatsWidget(const std::string& name, std::weak_ptr<Engine> engine)
+    : Widget(name), m_engine(engine) {}
+
+void knot::PhysicsStatsWidget::on_widget_render() {
+    auto engine = m_engine.lock();
+    if (!engine) {
+        return;
+    }
+    auto physics = engine->get_physics_module().lock();
+    if (!physics) {
+        return;
+    }
+    const PhysicsStatistics& stats = physics->get_statistics();
+
+    // one sample per frame that stepped, frames without a step would flatten the plot
+    if (stats.steps != m_lastStep) {
+        m_lastStep = stats.steps;
+        m_stepHistory[m_historyOffset] = static_cast<float>(stats.stepMs);
+        m_historyOffset = (m_historyOffset + 1) % HISTORY_SIZE;
+    }
+
+    ImGui::Begin("physics");
+    ImGui::Text("step %llu", static_cast<unsigned long long>(stats.steps));
+    ImGui::Text("step %.3f ms, simulate %.3f ms, fetchResults %.3f ms", stats.stepMs, stats.simulateMs,
+                stats.fetchResultsMs);
+    ImGui::PlotLines("step ms", m_stepHistory.data(), static_cast<int>(HISTORY_SIZE), static_cast<int>(m_historyOffset),
+                     nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+    ImGui::Separator();
+    ImGui::Text("bodies %u active / %u dynamic, %u kinematic active, %u static", stats.activeBodies,
+                stats.dynamicBodies, stats.activeKinematicBodies, stats.staticBodies);
+    ImGui::Text("constraints %u", stats.activeConstraints);
+    ImGui::Text("pairs %u, touching %u, new %u, lost %u", stats.contactPairs, stats.touchingPairs, stats.newTouches,
+                stats.lostTouches);
+    ImGui::Text("broadphase adds %u, removes %u", stats.broadPhaseAdds, stats.broadPhaseRemoves);
+    ImGui::End();
+}
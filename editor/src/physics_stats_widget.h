@@ -0,0 +1,24 @@
+#pragma once
+#include <imgui.h>
+#include <knoting/engine.h>
+#include <array>
+#include <cfloat>
+#include "widget.h"
+namespace knot {
+
+// Statistics of the latest physics step and a plot of the recent step times
+class PhysicsStatsWidget : public Widget {
+   public:
+    PhysicsStatsWidget(const std::string& name, std::weak_ptr<Engine> engine);
+    void on_widget_render() override;
+
+   private:
+    static constexpr size_t HISTORY_SIZE = 240;
+
+    std::weak_ptr<Engine> m_engine;
+    std::array<float, HISTORY_SIZE> m_stepHistory = {};
+    size_t m_historyOffset = 0;
+    uint64_t m_lastStep = 0;
+};
+
+}  // namespace knot